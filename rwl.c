@@ -1,5 +1,5 @@
 /*
-	Raw Wave Library version 1.0.2 2019-02-07 by Santtu Nyman.
+	Raw Wave Library version 1.1.0 2026-10-18 by Santtu Nyman.
 	git repository https://github.com/Santtu-Nyman/rwl
 */
 
@@ -9,6 +9,16 @@ extern "C" {
 
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS
+#else
+#ifdef __linux__
+#define _GNU_SOURCE
+#else
+#define _POSIX_C_SOURCE 200809L
+#ifdef __APPLE__
+#define _DARWIN_C_SOURCE
+#endif
+#endif
+#define _FILE_OFFSET_BITS 64
 #endif
 
 #include "rwl.h"
@@ -17,6 +27,161 @@ extern "C" {
 #include <time.h>
 #include <stdio.h>
 #include <errno.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RWL_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#endif
+
+typedef struct rwl_thread
+{
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	pthread_t handle;
+#endif
+	int (*procedure)(void* parameter);
+	void* parameter;
+	int result;
+} rwl_thread;
+
+typedef struct rwl_monitor
+{
+#ifdef _WIN32
+	SRWLOCK lock;
+	CONDITION_VARIABLE condition;
+#else
+	pthread_mutex_t lock;
+	pthread_cond_t condition;
+#endif
+} rwl_monitor;
+
+typedef struct rwl_block_queue
+{
+	rwl_monitor monitor;
+	int abort;
+	size_t first;
+	size_t count;
+	void* blocks[2];
+	size_t lengths[2];
+} rwl_block_queue;
+
+typedef struct rwl_indexed_file
+{
+	char* name;
+	int is_directory;
+	rwl_wave_index_entry entry;
+} rwl_indexed_file;
+
+typedef struct rwl_directory_indexer
+{
+	rwl_monitor monitor;
+	const char* directory_name;
+	size_t directory_name_length;
+	size_t old_entry_count;
+	const rwl_wave_index_entry* old_entries;
+	const char* old_name_table;
+	size_t job_count;
+	size_t job_capacity;
+	rwl_indexed_file* jobs;
+	size_t file_count;
+	size_t file_capacity;
+	rwl_indexed_file* files;
+	size_t active_thread_count;
+	int error;
+} rwl_directory_indexer;
+
+typedef struct rwl_wave_index_mapping
+{
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#endif
+	void* data;
+	size_t size;
+} rwl_wave_index_mapping;
+
+typedef struct rwl_parallel_store
+{
+	rwl_monitor monitor;
+	size_t channel_count;
+	size_t sample_count;
+	const float* left_channel;
+	const float* rigth_channel;
+	size_t thread_count;
+	size_t peak_thread_index;
+	float* thread_peaks;
+	float multiplier;
+	size_t block_length;
+	size_t block_count;
+	size_t slot_count;
+	float* slots;
+	uint8_t* ready_slots;
+	size_t next_block;
+	size_t written_block_count;
+	int abort;
+} rwl_parallel_store;
+
+typedef struct rwl_transcoder
+{
+	int source_sample_type;
+	size_t source_sample_size;
+	size_t source_channel_count;
+	int sample_type;
+	size_t sample_size;
+	size_t channel_count;
+	const float* mix_matrix;
+	float* source_samples;
+	float* samples;
+	FILE* file;
+	rwl_block_queue source_free_queue;
+	rwl_block_queue source_full_queue;
+	rwl_block_queue free_queue;
+	rwl_block_queue full_queue;
+} rwl_transcoder;
+
+struct rwl_recorder
+{
+	FILE* file;
+	int sample_type;
+	size_t sample_size;
+	size_t channel_count;
+	size_t sample_rate;
+	size_t header_size;
+	size_t maximum_frame_count;
+	size_t queue_length;
+	float* queue;
+	size_t block_length;
+	void* block;
+	volatile size_t write_index;
+	volatile size_t read_index;
+	volatile size_t stored_frame_count;
+	volatile size_t lost_frame_count;
+	volatile size_t overrun_count;
+	volatile size_t stop;
+	volatile size_t error;
+	rwl_thread thread;
+};
+
+typedef struct rwl_hash_state
+{
+	uint64_t accumulators[4];
+	uint64_t total_size;
+	size_t buffer_size;
+	uint8_t buffer[32];
+} rwl_hash_state;
 
 typedef struct rwl_riff_chunk
 {
@@ -28,8 +193,32 @@ typedef struct rwl_riff_chunk
 	void* sub_chunks;
 } rwl_riff_chunk;
 
+static const float rwl_stereo_channel_multipliers[18][2] = {
+	{ 0.75f, 0.25f },// front left
+	{ 0.25f, 0.75f },// front right
+	{ 0.5f, 0.5f },// front center
+	{ 0.5f, 0.5f },// low frequency
+	{ 0.75f, 0.25f },// back left
+	{ 0.25f, 0.75f },// back right
+	{ 0.75f, 0.25f },// front left of center
+	{ 0.25f, 0.75f },// front right of center
+	{ 0.5f, 0.5f },// back center
+	{ 1.0f, 0.0f },// left
+	{ 0.0f, 1.0f },// right
+	{ 0.5f, 0.5f },// top center
+	{ 0.75f, 0.25f },// top front left
+	{ 0.5f, 0.5f },// top front center
+	{ 0.25f, 0.75f },// top front right
+	{ 0.75f, 0.25f },// top back left
+	{ 0.5f, 0.5f },// top back center
+	{ 0.25f, 0.75f } };// top back right
+
 static int rwl_load_file(const char* file_name, size_t* file_size, void** file_data);
 
+static int rwl_create_temporal_file(const char* file_name, char** temporal_file_name, FILE** file);
+
+static int rwl_replace_file(const char* temporal_file_name, const char* file_name);
+
 static int rwl_store_file(const char* file_name, size_t file_size, const void* file_data);
 
 static int rwl_create_riff_tree(size_t size, const void* data, rwl_riff_chunk** root);
@@ -42,6 +231,120 @@ static float rwl_get_signal_absolute_peak(size_t sample_count, const float* sign
 
 static void rwl_scale_signal(size_t sample_count, float* signal, float multiplier);
 
+static uint64_t rwl_read_hash_word(const uint8_t* data);
+
+static uint64_t rwl_hash_round(uint64_t accumulator, uint64_t input);
+
+static void rwl_begin_hash(rwl_hash_state* state);
+
+static void rwl_update_hash(rwl_hash_state* state, const void* data, size_t size);
+
+static uint64_t rwl_finish_hash(rwl_hash_state* state);
+
+static float rwl_get_mean_square(int sample_type, size_t sample_size, size_t sample_count, const void* data);
+
+static int rwl_find_voice_activity(int sample_type, size_t sample_size, size_t channel_count, size_t sample_count, const void* data, float threshold, size_t block_length, size_t* first_sample, size_t* last_sample, uint8_t** block_activity);
+
+static int rwl_decode_wave(size_t file_size, const void* file_data, float trim_threshold, size_t trim_block_length, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel, size_t* trim_offset, uint8_t* voice_activity, uint64_t* data_hash);
+
+static int rwl_load_wave(const char* file_name, float trim_threshold, size_t trim_block_length, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel, size_t* trim_offset, uint8_t* voice_activity, uint64_t* data_hash);
+
+static int rwl_encode_wave(size_t sample_rate, size_t sample_count, const float* left_channel, const float* rigth_channel, size_t* buffer_size, void** buffer, size_t* wave_size);
+
+static size_t rwl_atomic_load(volatile size_t* variable);
+
+static void rwl_atomic_store(volatile size_t* variable, size_t value);
+
+static int rwl_create_thread(rwl_thread* thread, int (*procedure)(void* parameter), void* parameter);
+
+static int rwl_wait_thread(rwl_thread* thread);
+
+static void rwl_sleep(size_t milliseconds);
+
+static int rwl_create_monitor(rwl_monitor* monitor);
+
+static void rwl_destroy_monitor(rwl_monitor* monitor);
+
+static void rwl_enter_monitor(rwl_monitor* monitor);
+
+static void rwl_leave_monitor(rwl_monitor* monitor);
+
+static void rwl_wait_monitor(rwl_monitor* monitor);
+
+static void rwl_notify_monitor(rwl_monitor* monitor);
+
+static int rwl_create_block_queue(rwl_block_queue* queue);
+
+static void rwl_destroy_block_queue(rwl_block_queue* queue);
+
+static void rwl_push_block(rwl_block_queue* queue, void* block, size_t length);
+
+static int rwl_pop_block(rwl_block_queue* queue, void** block, size_t* length);
+
+static void rwl_abort_block_queue(rwl_block_queue* queue);
+
+static int rwl_is_supported_sample_format(int sample_type, size_t sample_size);
+
+static uint32_t rwl_get_default_channel_mask(size_t channel_count);
+
+static size_t rwl_create_wave_header(int sample_type, size_t sample_size, size_t channel_count, uint32_t channel_mask, size_t sample_rate, size_t data_size, void* header);
+
+static void rwl_encode_samples(int sample_type, size_t sample_size, size_t sample_count, const float* samples, void* buffer);
+
+static void rwl_decode_samples(int sample_type, size_t sample_size, size_t sample_count, const void* buffer, float* samples);
+
+static int rwl_update_recorder_file_header(rwl_recorder* recorder, size_t frame_count, int padded);
+
+static int rwl_recorder_thread(void* parameter);
+
+static int rwl_seek_file(FILE* file, uint64_t offset);
+
+static int rwl_write_file_at(FILE* file, uint64_t offset, size_t size, const void* data);
+
+static size_t rwl_read_stdio(void* context, void* buffer, size_t size);
+
+static int rwl_seek_stdio(void* context, uint64_t offset);
+
+static size_t rwl_write_stdio(void* context, const void* data, size_t size);
+
+static size_t rwl_read_io(const rwl_io* io, void* buffer, size_t size);
+
+static int rwl_read_wave_header(const rwl_io* io, int* sample_type, size_t* sample_size, size_t* channel_count, uint32_t* channel_mask, size_t* sample_rate, size_t* sample_count, uint64_t* data_offset, size_t* fmt_size, void* fmt_data);
+
+static int rwl_read_wave_file_header(FILE* file, int* sample_type, size_t* sample_size, size_t* channel_count, uint32_t* channel_mask, size_t* sample_rate, size_t* sample_count, uint64_t* data_offset, size_t* fmt_size, void* fmt_data);
+
+static int rwl_copy_file_data(FILE* destination_file, uint64_t destination_offset, FILE* source_file, uint64_t source_offset, uint64_t size);
+
+static int rwl_create_wave_file_from_fmt(const char* file_name, size_t fmt_size, const void* fmt_data, size_t data_size, size_t source_count, FILE** source_files, const uint64_t* source_offsets, const size_t* source_sizes);
+
+static size_t rwl_get_processor_count(void);
+
+static int rwl_validate_wave_index(size_t size, const void* data, size_t* entry_count, const rwl_wave_index_entry** entries, const char** name_table);
+
+static int rwl_append_indexed_file(rwl_directory_indexer* indexer, int job, char* name, int is_directory, const rwl_wave_index_entry* entry);
+
+static int rwl_index_directory_entry(rwl_directory_indexer* indexer, const char* directory, const char* name, int is_directory, uint64_t file_size, int64_t modification_time);
+
+static int rwl_index_directory_job(rwl_directory_indexer* indexer, rwl_indexed_file* job);
+
+static int rwl_directory_indexer_thread(void* parameter);
+
+static int rwl_compare_indexed_files(const void* a, const void* b);
+
+static int rwl_parallel_store_peak_thread(void* parameter);
+
+static void rwl_convert_parallel_store_block(rwl_parallel_store* store, size_t block_index);
+
+static int rwl_parallel_store_convert_thread(void* parameter);
+
+static void rwl_run_parallel_store_threads(rwl_parallel_store* store, int (*procedure)(void* parameter), rwl_thread* threads);
+
+static void rwl_abort_transcoder(rwl_transcoder* transcoder);
+
+static int rwl_transcoder_convert_thread(void* parameter);
+
+static int rwl_transcoder_write_thread(void* parameter);
+
 static int rwl_load_file(const char* file_name, size_t* file_size, void** file_data)
 {
 	int error;
@@ -101,13 +404,13 @@ static int rwl_load_file(const char* file_name, size_t* file_size, void** file_d
 	return 0;
 }
 
-static int rwl_store_file(const char* file_name, size_t file_size, const void* file_data)
+static int rwl_create_temporal_file(const char* file_name, char** temporal_file_name, FILE** file)
 {
 	int error;
 	size_t file_name_length = strlen(file_name);
 	size_t temporal_file_name_length = file_name_length + 28;
-	char* temporal_file_name = (char*)malloc(temporal_file_name_length * sizeof(char));
-	if (!temporal_file_name)
+	char* new_temporal_file_name = (char*)malloc(temporal_file_name_length * sizeof(char));
+	if (!new_temporal_file_name)
 	{
 		error = ENOMEM;
 		return error;
@@ -116,60 +419,93 @@ static int rwl_store_file(const char* file_name, size_t file_size, const void* f
 	struct tm* current_date = (time(&current_time) != -1) ? localtime(&current_time) : 0;
 	if (current_date)
 	{
-		memcpy(temporal_file_name, file_name, file_name_length);
-		temporal_file_name[file_name_length] = '.';
+		memcpy(new_temporal_file_name, file_name, file_name_length);
+		new_temporal_file_name[file_name_length] = '.';
 		for (int i = 0, v = 99; i != 2; ++i, v /= 10)
-			temporal_file_name[file_name_length + 1 + 1 - i] = '0' + (char)(v % 10);
-		temporal_file_name[file_name_length + 3] = '-';
+			new_temporal_file_name[file_name_length + 1 + 1 - i] = '0' + (char)(v % 10);
+		new_temporal_file_name[file_name_length + 3] = '-';
 		for (int i = 0, v = 1900 + current_date->tm_year; i != 4; ++i, v /= 10)
-			temporal_file_name[file_name_length + 4 + 3 - i] = '0' + (char)(v % 10);
-		temporal_file_name[file_name_length + 8] = '-';
+			new_temporal_file_name[file_name_length + 4 + 3 - i] = '0' + (char)(v % 10);
+		new_temporal_file_name[file_name_length + 8] = '-';
 		for (int i = 0, v = 1 + current_date->tm_mon; i != 2; ++i, v /= 10)
-			temporal_file_name[file_name_length + 9 + 1 - i] = '0' + (char)(v % 10);
-		temporal_file_name[file_name_length + 11] = '-';
+			new_temporal_file_name[file_name_length + 9 + 1 - i] = '0' + (char)(v % 10);
+		new_temporal_file_name[file_name_length + 11] = '-';
 		for (int i = 0, v = current_date->tm_mday; i != 2; ++i, v /= 10)
-			temporal_file_name[file_name_length + 12 + 1 - i] = '0' + (char)(v % 10);
-		temporal_file_name[file_name_length + 14] = '-';
+			new_temporal_file_name[file_name_length + 12 + 1 - i] = '0' + (char)(v % 10);
+		new_temporal_file_name[file_name_length + 14] = '-';
 		for (int i = 0, v = current_date->tm_hour; i != 2; ++i, v /= 10)
-			temporal_file_name[file_name_length + 15 + 1 - i] = '0' + (char)(v % 10);
-		temporal_file_name[file_name_length + 17] = '-';
+			new_temporal_file_name[file_name_length + 15 + 1 - i] = '0' + (char)(v % 10);
+		new_temporal_file_name[file_name_length + 17] = '-';
 		for (int i = 0, v = current_date->tm_min; i != 2; ++i, v /= 10)
-			temporal_file_name[file_name_length + 18 + 1 - i] = '0' + (char)(v % 10);
-		temporal_file_name[file_name_length + 20] = '-';
+			new_temporal_file_name[file_name_length + 18 + 1 - i] = '0' + (char)(v % 10);
+		new_temporal_file_name[file_name_length + 20] = '-';
 		for (int i = 0, v = current_date->tm_sec; i != 2; ++i, v /= 10)
-			temporal_file_name[file_name_length + 21 + 1 - i] = '0' + (char)(v % 10);
-		memcpy(temporal_file_name + file_name_length + 23, ".tmp", 5);
+			new_temporal_file_name[file_name_length + 21 + 1 - i] = '0' + (char)(v % 10);
+		memcpy(new_temporal_file_name + file_name_length + 23, ".tmp", 5);
 	}
 	else
-		memcpy(temporal_file_name + file_name_length, ".99-XXXX-XX-XX-XX-XX-XX.tmp", 28);
-	FILE* file = 0;
-	for (int count = 99; !file;)
+		memcpy(new_temporal_file_name + file_name_length, ".99-XXXX-XX-XX-XX-XX-XX.tmp", 28);
+	FILE* new_file = 0;
+	for (int count = 99; !new_file;)
 	{
-		file = fopen(temporal_file_name, "rb");
-		if (!file)
+		new_file = fopen(new_temporal_file_name, "rb");
+		if (!new_file)
 		{
-			file = fopen(temporal_file_name, "wb");
-			if (!file)
+			new_file = fopen(new_temporal_file_name, "wb");
+			if (!new_file)
 			{
 				error = errno;
-				free(temporal_file_name);
+				free(new_temporal_file_name);
 				return error;
 			}
 		}
 		else
 		{
-			fclose(file);
-			file = 0;
+			fclose(new_file);
+			new_file = 0;
 			if (!count)
 			{
 				error = EEXIST;
-				free(temporal_file_name);
+				free(new_temporal_file_name);
 				return error;
 			}
 			for (int i = 0, v = --count; i != 2; ++i, v /= 10)
-				temporal_file_name[file_name_length + 1 + 1 - i] = '0' + (char)(v % 10);
+				new_temporal_file_name[file_name_length + 1 + 1 - i] = '0' + (char)(v % 10);
 		}
 	}
+	*temporal_file_name = new_temporal_file_name;
+	*file = new_file;
+	return 0;
+}
+
+static int rwl_replace_file(const char* temporal_file_name, const char* file_name)
+{
+	int error;
+	if (rename(temporal_file_name, file_name))
+	{
+		if (remove(file_name))
+		{
+			error = errno;
+			remove(temporal_file_name);
+			return error;
+		}
+		if (rename(temporal_file_name, file_name))
+		{
+			error = errno;
+			remove(temporal_file_name);
+			return error;
+		}
+	}
+	return 0;
+}
+
+static int rwl_store_file(const char* file_name, size_t file_size, const void* file_data)
+{
+	char* temporal_file_name;
+	FILE* file;
+	int error = rwl_create_temporal_file(file_name, &temporal_file_name, &file);
+	if (error)
+		return error;
 	for (size_t written = 0, write_result; written != file_size; written += write_result)
 	{
 		write_result = fwrite((const void*)((uintptr_t)file_data + written), 1, file_size - written, file);
@@ -191,25 +527,9 @@ static int rwl_store_file(const char* file_name, size_t file_size, const void* f
 		return error;
 	}
 	fclose(file);
-	if (rename(temporal_file_name, file_name))
-	{
-		if (remove(file_name))
-		{
-			error = errno;
-			remove(temporal_file_name);
-			free(temporal_file_name);
-			return error;
-		}
-		if (rename(temporal_file_name, file_name))
-		{
-			error = errno;
-			remove(temporal_file_name);
-			free(temporal_file_name);
-			return error;
-		}
-	}
+	error = rwl_replace_file(temporal_file_name, file_name);
 	free(temporal_file_name);
-	return 0;
+	return error;
 }
 
 static int rwl_create_riff_tree(size_t size, const void* data, rwl_riff_chunk** root)
@@ -222,7 +542,7 @@ static int rwl_create_riff_tree(size_t size, const void* data, rwl_riff_chunk**
 	memcpy(root_chunk->identifier, data, 4);
 	root_chunk->size = (size_t)*(const uint8_t*)((uintptr_t)data + 4) | ((size_t)*(const uint8_t*)((uintptr_t)data + 5) << 8) | ((size_t)*(const uint8_t*)((uintptr_t)data + 6) << 16) | ((size_t)*(const uint8_t*)((uintptr_t)data + 7) << 24);
 	root_chunk->data = (const void*)((uintptr_t)data + 8);
-	if ((size_t)((uintptr_t)root_chunk->data - (uintptr_t)data) > size || (size_t)((uintptr_t)root_chunk->data - (uintptr_t)data) + root_chunk->size > (size_t)((uintptr_t)data + (uintptr_t)size))
+	if ((size_t)((uintptr_t)root_chunk->data - (uintptr_t)data) > size || root_chunk->size > size - (size_t)((uintptr_t)root_chunk->data - (uintptr_t)data))
 	{
 		free(root_chunk);
 		return EILSEQ;
@@ -244,7 +564,7 @@ static int rwl_create_riff_tree(size_t size, const void* data, rwl_riff_chunk**
 			for (size_t chunk_pointer = 4; chunk->size - chunk_pointer >= 8;)
 			{
 				size_t sub_chunk_size = (size_t)*(const uint8_t*)((uintptr_t)chunk->data + chunk_pointer + 4) | ((size_t)*(const uint8_t*)((uintptr_t)chunk->data + chunk_pointer + 5) << 8) | ((size_t)*(const uint8_t*)((uintptr_t)chunk->data + chunk_pointer + 6) << 16) | ((size_t)*(const uint8_t*)((uintptr_t)chunk->data + chunk_pointer + 7) << 24);
-				if (chunk_pointer + sub_chunk_size > chunk->size)
+				if (sub_chunk_size > chunk->size - chunk_pointer - 8)
 				{
 					free(root_chunk);
 					return EILSEQ;
@@ -319,7 +639,7 @@ static int rwl_get_audio_format(rwl_riff_chunk* chunk, int* sample_type, size_t*
 	if (!chunk || *(const char*)((uintptr_t)chunk->data) != 'W' || *(const char*)((uintptr_t)chunk->data + 1) != 'A' || *(const char*)((uintptr_t)chunk->data + 2) != 'V' || *(const char*)((uintptr_t)chunk->data + 3) != 'E')
 		return ENOENT;
 	rwl_riff_chunk* fmt = rwl_get_riff_chunk(chunk, "RIFFfmt ");
-	if (!chunk)
+	if (!fmt)
 		return ENOENT;
 	if (fmt->size < 16)
 		return ENOENT;
@@ -329,6 +649,8 @@ static int rwl_get_audio_format(rwl_riff_chunk* chunk, int* sample_type, size_t*
 	uint32_t fmt_byte_rate = (uint32_t)*(const uint8_t*)((uintptr_t)fmt->data + 8) | ((uint32_t)*(const uint8_t*)((uintptr_t)fmt->data + 9) << 8) | ((uint32_t)*(const uint8_t*)((uintptr_t)fmt->data + 10) << 16) | ((uint32_t)*(const uint8_t*)((uintptr_t)fmt->data + 11) << 24);
 	uint16_t fmt_frame_size = (uint16_t)*(const uint8_t*)((uintptr_t)fmt->data + 12) | ((uint16_t)*(const uint8_t*)((uintptr_t)fmt->data + 13) << 8);
 	uint16_t fmt_bits_per_sample = (uint16_t)*(const uint8_t*)((uintptr_t)fmt->data + 14) | ((uint16_t)*(const uint8_t*)((uintptr_t)fmt->data + 15) << 8);
+	if (!fmt_channel_count || fmt_bits_per_sample < 8)
+		return EILSEQ;
 	size_t fmt_extension_size = 0;
 	uint16_t fmt_valid_bits_per_sample = 0;
 	uint32_t fmt_channel_mask = 0;
@@ -407,342 +729,1813 @@ static void rwl_scale_signal(size_t sample_count, float* signal, float multiplie
 		*signal *= multiplier;
 }
 
-int rwl_load_wave_file(const char* file_name, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel)
+#define RWL_HASH_PRIME_1 0x9E3779B185EBCA87ULL
+#define RWL_HASH_PRIME_2 0xC2B2AE3D27D4EB4FULL
+#define RWL_HASH_PRIME_3 0x165667B19E3779F9ULL
+#define RWL_HASH_PRIME_4 0x85EBCA77C2B2AE63ULL
+#define RWL_HASH_PRIME_5 0x27D4EB2F165667C5ULL
+#define RWL_HASH_ROTATE(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static uint64_t rwl_read_hash_word(const uint8_t* data)
 {
-	size_t file_size;
-	void* file_data;
-	int error = rwl_load_file(file_name, &file_size, &file_data);
-	if (error)
-		return error;
-	rwl_riff_chunk* file_riff;
-	error = rwl_create_riff_tree(file_size, file_data, &file_riff);
-	if (error)
+	return (uint64_t)data[0] | ((uint64_t)data[1] << 8) | ((uint64_t)data[2] << 16) | ((uint64_t)data[3] << 24) |
+		((uint64_t)data[4] << 32) | ((uint64_t)data[5] << 40) | ((uint64_t)data[6] << 48) | ((uint64_t)data[7] << 56);
+}
+
+static uint64_t rwl_hash_round(uint64_t accumulator, uint64_t input)
+{
+	accumulator += input * RWL_HASH_PRIME_2;
+	accumulator = RWL_HASH_ROTATE(accumulator, 31);
+	return accumulator * RWL_HASH_PRIME_1;
+}
+
+static void rwl_begin_hash(rwl_hash_state* state)
+{
+	state->accumulators[0] = RWL_HASH_PRIME_1 + RWL_HASH_PRIME_2;
+	state->accumulators[1] = RWL_HASH_PRIME_2;
+	state->accumulators[2] = 0;
+	state->accumulators[3] = 0 - RWL_HASH_PRIME_1;
+	state->total_size = 0;
+	state->buffer_size = 0;
+}
+
+static void rwl_update_hash(rwl_hash_state* state, const void* data, size_t size)
+{
+	const uint8_t* input = (const uint8_t*)data;
+	const uint8_t* input_end = input + size;
+	state->total_size += (uint64_t)size;
+	if (state->buffer_size)
 	{
-		free(file_data);
-		return error;
+		size_t fill_size = 32 - state->buffer_size;
+		if (size < fill_size)
+		{
+			memcpy(state->buffer + state->buffer_size, input, size);
+			state->buffer_size += size;
+			return;
+		}
+		memcpy(state->buffer + state->buffer_size, input, fill_size);
+		input += fill_size;
+		for (size_t i = 0; i != 4; ++i)
+			state->accumulators[i] = rwl_hash_round(state->accumulators[i], rwl_read_hash_word(state->buffer + i * 8));
+		state->buffer_size = 0;
 	}
-	int file_sample_type;
-	size_t file_sample_size;
-	size_t file_channel_count;
-	uint32_t file_channel_mask;
-	size_t file_sample_rate;
-	size_t file_sample_count;
-	error = rwl_get_audio_format(file_riff, &file_sample_type, &file_sample_size, &file_channel_count, &file_channel_mask, &file_sample_rate, &file_sample_count);
-	if (error)
+	uint64_t accumulator_0 = state->accumulators[0];
+	uint64_t accumulator_1 = state->accumulators[1];
+	uint64_t accumulator_2 = state->accumulators[2];
+	uint64_t accumulator_3 = state->accumulators[3];
+	for (; (size_t)(input_end - input) >= 32; input += 32)
 	{
-		free(file_data);
-		return error;
+		accumulator_0 = rwl_hash_round(accumulator_0, rwl_read_hash_word(input));
+		accumulator_1 = rwl_hash_round(accumulator_1, rwl_read_hash_word(input + 8));
+		accumulator_2 = rwl_hash_round(accumulator_2, rwl_read_hash_word(input + 16));
+		accumulator_3 = rwl_hash_round(accumulator_3, rwl_read_hash_word(input + 24));
 	}
-	if (!((file_sample_type == 1) && (file_sample_size == 8 || file_sample_size == 16 || file_sample_size == 24 || file_sample_size == 32)) && !((file_sample_type == 3) && (file_sample_size == 32)))
+	state->accumulators[0] = accumulator_0;
+	state->accumulators[1] = accumulator_1;
+	state->accumulators[2] = accumulator_2;
+	state->accumulators[3] = accumulator_3;
+	state->buffer_size = (size_t)(input_end - input);
+	memcpy(state->buffer, input, state->buffer_size);
+}
+
+static uint64_t rwl_finish_hash(rwl_hash_state* state)
+{
+	uint64_t hash;
+	if (state->total_size >= 32)
 	{
-		free(file_data);
-		error = ENOTSUP;
-		return error;
+		hash = RWL_HASH_ROTATE(state->accumulators[0], 1) + RWL_HASH_ROTATE(state->accumulators[1], 7) + RWL_HASH_ROTATE(state->accumulators[2], 12) + RWL_HASH_ROTATE(state->accumulators[3], 18);
+		for (size_t i = 0; i != 4; ++i)
+			hash = (hash ^ rwl_hash_round(0, state->accumulators[i])) * RWL_HASH_PRIME_1 + RWL_HASH_PRIME_4;
 	}
-	size_t channel_count = (left_channel ? (size_t)1 : (size_t)0) + (rigth_channel ? (size_t)1 : (size_t)0);
-	if (!channel_count)
+	else
+		hash = state->accumulators[2] + RWL_HASH_PRIME_5;
+	hash += state->total_size;
+	const uint8_t* input = state->buffer;
+	const uint8_t* input_end = input + state->buffer_size;
+	for (; (size_t)(input_end - input) >= 8; input += 8)
 	{
-		free(file_data);
-		*sample_rate = file_sample_rate;
-		*sample_count = file_sample_count;
-		return 0;
+		hash ^= rwl_hash_round(0, rwl_read_hash_word(input));
+		hash = RWL_HASH_ROTATE(hash, 27) * RWL_HASH_PRIME_1 + RWL_HASH_PRIME_4;
 	}
-	if (channel_count == 2)
+	if ((size_t)(input_end - input) >= 4)
 	{
-		uint32_t file_channel_mask_channel_count = 0;
-		for (uint32_t i = 0; i != 32; ++i)
-			if (file_channel_mask & (1 << i))
-				++file_channel_mask_channel_count;
-		if (file_channel_mask_channel_count != file_channel_count)
-		{
-			free(file_data);
-			error = ENOTSUP;
-			return error;
-		}
+		hash ^= ((uint64_t)input[0] | ((uint64_t)input[1] << 8) | ((uint64_t)input[2] << 16) | ((uint64_t)input[3] << 24)) * RWL_HASH_PRIME_1;
+		hash = RWL_HASH_ROTATE(hash, 23) * RWL_HASH_PRIME_2 + RWL_HASH_PRIME_3;
+		input += 4;
 	}
-	if (*sample_count < file_sample_count)
+	for (; input != input_end; ++input)
 	{
-		free(file_data);
-		*sample_rate = file_sample_rate;
-		*sample_count = file_sample_count;
-		return ENOBUFS;
+		hash ^= (uint64_t)*input * RWL_HASH_PRIME_5;
+		hash = RWL_HASH_ROTATE(hash, 11) * RWL_HASH_PRIME_1;
 	}
-	rwl_riff_chunk* wave_data = rwl_get_riff_chunk(file_riff, "RIFFdata");
-	if (!wave_data)
+	hash ^= hash >> 33;
+	hash *= RWL_HASH_PRIME_2;
+	hash ^= hash >> 29;
+	hash *= RWL_HASH_PRIME_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+static size_t rwl_atomic_load(volatile size_t* variable)
+{
+#ifdef _WIN32
+	size_t value = *variable;
+	MemoryBarrier();
+	return value;
+#else
+	return __atomic_load_n(variable, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void rwl_atomic_store(volatile size_t* variable, size_t value)
+{
+#ifdef _WIN32
+	MemoryBarrier();
+	*variable = value;
+#else
+	__atomic_store_n(variable, value, __ATOMIC_RELEASE);
+#endif
+}
+
+#ifdef _WIN32
+static DWORD WINAPI rwl_thread_entry(LPVOID parameter)
+{
+	rwl_thread* thread = (rwl_thread*)parameter;
+	thread->result = thread->procedure(thread->parameter);
+	return 0;
+}
+#else
+static void* rwl_thread_entry(void* parameter)
+{
+	rwl_thread* thread = (rwl_thread*)parameter;
+	thread->result = thread->procedure(thread->parameter);
+	return 0;
+}
+#endif
+
+static int rwl_create_thread(rwl_thread* thread, int (*procedure)(void* parameter), void* parameter)
+{
+	thread->procedure = procedure;
+	thread->parameter = parameter;
+	thread->result = 0;
+#ifdef _WIN32
+	thread->handle = CreateThread(0, 0, rwl_thread_entry, thread, 0, 0);
+	if (!thread->handle)
+		return ENOMEM;
+	return 0;
+#else
+	return pthread_create(&thread->handle, 0, rwl_thread_entry, thread);
+#endif
+}
+
+static int rwl_wait_thread(rwl_thread* thread)
+{
+#ifdef _WIN32
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+#else
+	pthread_join(thread->handle, 0);
+#endif
+	return thread->result;
+}
+
+static void rwl_sleep(size_t milliseconds)
+{
+#ifdef _WIN32
+	Sleep((DWORD)milliseconds);
+#else
+	struct timespec time = { (time_t)(milliseconds / 1000), (long)((milliseconds % 1000) * 1000000) };
+	while (nanosleep(&time, &time) && errno == EINTR)
+		continue;
+#endif
+}
+
+static int rwl_create_monitor(rwl_monitor* monitor)
+{
+#ifdef _WIN32
+	InitializeSRWLock(&monitor->lock);
+	InitializeConditionVariable(&monitor->condition);
+	return 0;
+#else
+	int error = pthread_mutex_init(&monitor->lock, 0);
+	if (error)
+		return error;
+	error = pthread_cond_init(&monitor->condition, 0);
+	if (error)
 	{
-		free(file_data);
-		error = ENOTSUP;
+		pthread_mutex_destroy(&monitor->lock);
 		return error;
 	}
-	const uint8_t* file_sample_data = (const uint8_t*)wave_data->data;
-	if (channel_count == 1)
-	{
-		float* samples = left_channel ? left_channel : rigth_channel;
-		if (file_sample_type == 1)
-		{
-			if (file_sample_size == 8)
-			{
-				for (size_t i = 0; i != file_sample_count; ++i)
-				{
-					float sample = 0.0f;
-					for (size_t j = 0; j != file_channel_count; ++j)
-						sample += ((float)file_sample_data[i * file_channel_count + j] - 127.5f) / 127.5f;
-					samples[i] = sample;
-				}
-			}
-			else if (file_sample_size == 16)
-			{
-				int16_t channel_raw_sample;
-				for (size_t i = 0; i != file_sample_count; ++i)
-				{
-					float sample = 0.0f;
-					for (size_t j = 0; j != file_channel_count; ++j)
-					{
-						*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 2];
-						*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 2 + 1];
-						sample += (float)channel_raw_sample / 32768.0f;
-					}
-					samples[i] = sample;
-				}
-			}
-			else if (file_sample_size == 24)
-			{
-				int32_t channel_raw_sample;
-				*((uint8_t*)&channel_raw_sample + 3) = 0;
-				for (size_t i = 0; i != file_sample_count; ++i)
-				{
-					float sample = 0.0f;
-					for (size_t j = 0; j != file_channel_count; ++j)
-					{
-						*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 3];
-						*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 3 + 1];
-						*((uint8_t*)&channel_raw_sample + 2) = file_sample_data[(i * file_channel_count + j) * 3 + 2];
-						sample += (channel_raw_sample & 0x800000) ? ((float)(channel_raw_sample - 16777216) / 8388608.0f) : (((float)channel_raw_sample) / 8388608.0f);
-					}
-					samples[i] = sample;
-				}
-			}
-			else if (file_sample_size == 32)
-			{
-				int32_t channel_raw_sample;
-				for (size_t i = 0; i != file_sample_count; ++i)
-				{
-					float sample = 0.0f;
-					for (size_t j = 0; j != file_channel_count; ++j)
-					{
-						*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 4];
-						*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 4 + 1];
-						*((uint8_t*)&channel_raw_sample + 2) = file_sample_data[(i * file_channel_count + j) * 4 + 2];
-						*((uint8_t*)&channel_raw_sample + 3) = file_sample_data[(i * file_channel_count + j) * 4 + 3];
-						sample += (float)channel_raw_sample / 2147483648.0f;
-					}
-					samples[i] = sample;
-				}
-			}
-			else
-			{
-				free(file_data);
-				error = ENOSYS;
-				return error;
-			}
-		}
-		else if (file_sample_type == 3)
+	return 0;
+#endif
+}
+
+static void rwl_destroy_monitor(rwl_monitor* monitor)
+{
+#ifdef _WIN32
+	(void)monitor;
+#else
+	pthread_cond_destroy(&monitor->condition);
+	pthread_mutex_destroy(&monitor->lock);
+#endif
+}
+
+static void rwl_enter_monitor(rwl_monitor* monitor)
+{
+#ifdef _WIN32
+	AcquireSRWLockExclusive(&monitor->lock);
+#else
+	pthread_mutex_lock(&monitor->lock);
+#endif
+}
+
+static void rwl_leave_monitor(rwl_monitor* monitor)
+{
+#ifdef _WIN32
+	ReleaseSRWLockExclusive(&monitor->lock);
+#else
+	pthread_mutex_unlock(&monitor->lock);
+#endif
+}
+
+static void rwl_wait_monitor(rwl_monitor* monitor)
+{
+#ifdef _WIN32
+	SleepConditionVariableSRW(&monitor->condition, &monitor->lock, INFINITE, 0);
+#else
+	pthread_cond_wait(&monitor->condition, &monitor->lock);
+#endif
+}
+
+static void rwl_notify_monitor(rwl_monitor* monitor)
+{
+#ifdef _WIN32
+	WakeAllConditionVariable(&monitor->condition);
+#else
+	pthread_cond_broadcast(&monitor->condition);
+#endif
+}
+
+static int rwl_create_block_queue(rwl_block_queue* queue)
+{
+	int error = rwl_create_monitor(&queue->monitor);
+	if (error)
+		return error;
+	queue->abort = 0;
+	queue->first = 0;
+	queue->count = 0;
+	return 0;
+}
+
+static void rwl_destroy_block_queue(rwl_block_queue* queue)
+{
+	rwl_destroy_monitor(&queue->monitor);
+}
+
+static void rwl_push_block(rwl_block_queue* queue, void* block, size_t length)
+{
+	const size_t capacity = sizeof(queue->blocks) / sizeof(*queue->blocks);
+	rwl_enter_monitor(&queue->monitor);
+	queue->blocks[(queue->first + queue->count) % capacity] = block;
+	queue->lengths[(queue->first + queue->count) % capacity] = length;
+	queue->count++;
+	rwl_notify_monitor(&queue->monitor);
+	rwl_leave_monitor(&queue->monitor);
+}
+
+static int rwl_pop_block(rwl_block_queue* queue, void** block, size_t* length)
+{
+	const size_t capacity = sizeof(queue->blocks) / sizeof(*queue->blocks);
+	rwl_enter_monitor(&queue->monitor);
+	while (!queue->count && !queue->abort)
+		rwl_wait_monitor(&queue->monitor);
+	int error = 0;
+	if (queue->abort)
+		error = ECANCELED;
+	else
+	{
+		*block = queue->blocks[queue->first];
+		*length = queue->lengths[queue->first];
+		queue->first = (queue->first + 1) % capacity;
+		queue->count--;
+	}
+	rwl_leave_monitor(&queue->monitor);
+	return error;
+}
+
+static void rwl_abort_block_queue(rwl_block_queue* queue)
+{
+	rwl_enter_monitor(&queue->monitor);
+	queue->abort = 1;
+	rwl_notify_monitor(&queue->monitor);
+	rwl_leave_monitor(&queue->monitor);
+}
+
+static int rwl_is_supported_sample_format(int sample_type, size_t sample_size)
+{
+	return ((sample_type == RWL_SAMPLE_TYPE_PCM) && (sample_size == 8 || sample_size == 16 || sample_size == 24 || sample_size == 32)) || ((sample_type == RWL_SAMPLE_TYPE_FLOAT) && (sample_size == 32));
+}
+
+static uint32_t rwl_get_default_channel_mask(size_t channel_count)
+{
+	return channel_count == 1 ? (uint32_t)0x00000004 : (uint32_t)((1 << channel_count) - 1);
+}
+
+static size_t rwl_create_wave_header(int sample_type, size_t sample_size, size_t channel_count, uint32_t channel_mask, size_t sample_rate, size_t data_size, void* header)
+{
+	uint8_t* wav = (uint8_t*)header;
+	int extensible = (channel_count > 2) || (sample_type == RWL_SAMPLE_TYPE_PCM && sample_size > 16) || (channel_mask != rwl_get_default_channel_mask(channel_count));
+	size_t fmt_size = extensible ? 40 : 16;
+	size_t header_size = 28 + fmt_size;
+	uint32_t riff_size = (uint32_t)(header_size - 8 + data_size + (data_size & 1));
+	uint32_t byte_rate = (uint32_t)(sample_rate * channel_count * (sample_size / 8));
+	uint16_t frame_size = (uint16_t)(channel_count * (sample_size / 8));
+	memcpy(wav, "RIFF", 4);
+	for (size_t i = 0; i != 4; ++i)
+		wav[4 + i] = (uint8_t)(riff_size >> (i * 8));
+	memcpy(wav + 8, "WAVEfmt ", 8);
+	for (size_t i = 0; i != 4; ++i)
+		wav[16 + i] = (uint8_t)(fmt_size >> (i * 8));
+	wav[20] = extensible ? (uint8_t)0xFE : (uint8_t)sample_type;
+	wav[21] = extensible ? (uint8_t)0xFF : (uint8_t)0x00;
+	wav[22] = (uint8_t)channel_count;
+	wav[23] = (uint8_t)(channel_count >> 8);
+	for (size_t i = 0; i != 4; ++i)
+		wav[24 + i] = (uint8_t)(sample_rate >> (i * 8));
+	for (size_t i = 0; i != 4; ++i)
+		wav[28 + i] = (uint8_t)(byte_rate >> (i * 8));
+	wav[32] = (uint8_t)frame_size;
+	wav[33] = (uint8_t)(frame_size >> 8);
+	wav[34] = (uint8_t)sample_size;
+	wav[35] = (uint8_t)(sample_size >> 8);
+	if (extensible)
+	{
+		const uint8_t sub_format_guid_tail[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 };
+		wav[36] = 22;
+		wav[37] = 0;
+		wav[38] = (uint8_t)sample_size;
+		wav[39] = (uint8_t)(sample_size >> 8);
+		for (size_t i = 0; i != 4; ++i)
+			wav[40 + i] = (uint8_t)(channel_mask >> (i * 8));
+		wav[44] = (uint8_t)sample_type;
+		wav[45] = 0;
+		memcpy(wav + 46, sub_format_guid_tail, 14);
+	}
+	memcpy(wav + header_size - 8, "data", 4);
+	for (size_t i = 0; i != 4; ++i)
+		wav[header_size - 4 + i] = (uint8_t)(data_size >> (i * 8));
+	return header_size;
+}
+
+static void rwl_encode_samples(int sample_type, size_t sample_size, size_t sample_count, const float* samples, void* buffer)
+{
+	uint8_t* data = (uint8_t*)buffer;
+	if (sample_type == RWL_SAMPLE_TYPE_FLOAT)
+	{
+		for (size_t i = 0; i != sample_count; ++i)
 		{
-			float channel_sample;
-			for (size_t i = 0; i != file_sample_count; ++i)
-			{
-				float sample = 0.0f;
-				for (size_t j = 0; j != file_channel_count; ++j)
-				{
-					*((uint8_t*)&channel_sample) = file_sample_data[(i * file_channel_count + j) * 4];
-					*((uint8_t*)&channel_sample + 1) = file_sample_data[(i * file_channel_count + j) * 4 + 1];
-					*((uint8_t*)&channel_sample + 2) = file_sample_data[(i * file_channel_count + j) * 4 + 2];
-					*((uint8_t*)&channel_sample + 3) = file_sample_data[(i * file_channel_count + j) * 4 + 3];
-					sample += channel_sample;
-				}
-				samples[i] = sample;
-			}
+			float sample = samples[i];
+			if (sample != sample)
+				sample = 0.0f;
+			memcpy(data + i * 4, &sample, 4);
 		}
-		else
+	}
+	else if (sample_size == 8)
+	{
+		for (size_t i = 0; i != sample_count; ++i)
 		{
-			free(file_data);
-			error = ENOSYS;
-			return error;
+			float sample = samples[i] * 127.5f + 127.5f;
+			data[i] = sample > 255.0f ? (uint8_t)255 : (sample > 0.0f ? (uint8_t)(sample + 0.5f) : (uint8_t)0);
 		}
-		float signal_peak = rwl_get_signal_absolute_peak(file_sample_count, samples);
-		if (signal_peak > 0.0009765625f)
-			rwl_scale_signal(file_sample_count, samples, 1.0f / signal_peak);
 	}
-	else if (channel_count == 2)
+	else
 	{
-		const float channel_multipliers[18][2] = {
-			{ 0.75f, 0.25f },// front left
-			{ 0.25f, 0.75f },// front right
-			{ 0.5f, 0.5f },// front center
-			{ 0.5f, 0.5f },// low frequency
-			{ 0.75f, 0.25f },// back left
-			{ 0.25f, 0.75f },// back right
-			{ 0.75f, 0.25f },// front left of center
-			{ 0.25f, 0.75f },// front right of center
-			{ 0.5f, 0.5f },// back center
-			{ 1.0f, 0.0f },// left
-			{ 0.0f, 1.0f },// right
-			{ 0.5f, 0.5f },// top center
-			{ 0.75f, 0.25f },// top front left
-			{ 0.5f, 0.5f },// top front center
-			{ 0.25f, 0.75f },// top front right
-			{ 0.75f, 0.25f },// top back left
-			{ 0.5f, 0.5f },// top back center
-			{ 0.25f, 0.75f } };// top back right
-		float channels[18][2];
-		for (size_t channel_index = 0, bit_index = 0; channel_index != file_channel_count; ++bit_index, ++channel_index)
+		size_t sample_bytes = sample_size / 8;
+		double scale = (double)((uint32_t)1 << (sample_size - 1));
+		double maximum = scale - 1.0;
+		for (size_t i = 0; i != sample_count; ++i)
 		{
-			while (!(file_channel_mask & (1 << (uint32_t)bit_index)))
-				++bit_index;
-			channels[channel_index][0] = channel_multipliers[bit_index][0];
-			channels[channel_index][1] = channel_multipliers[bit_index][1];
+			double sample = (double)samples[i] * scale;
+			int32_t value = sample >= maximum ? (int32_t)maximum : (sample <= -scale ? (int32_t)(-scale) : (sample > 0.0 ? (int32_t)(sample + 0.5) : (sample < 0.0 ? (int32_t)(sample - 0.5) : 0)));
+			for (size_t j = 0; j != sample_bytes; ++j)
+				data[i * sample_bytes + j] = (uint8_t)((uint32_t)value >> (j * 8));
 		}
-		if (file_sample_type == 1)
+	}
+}
+
+static void rwl_decode_samples(int sample_type, size_t sample_size, size_t sample_count, const void* buffer, float* samples)
+{
+	const uint8_t* data = (const uint8_t*)buffer;
+	if (sample_type == RWL_SAMPLE_TYPE_FLOAT)
+		memcpy(samples, data, sample_count * 4);
+	else if (sample_size == 8)
+	{
+		for (size_t i = 0; i != sample_count; ++i)
+			samples[i] = ((float)data[i] - 127.5f) / 127.5f;
+	}
+	else if (sample_size == 16)
+	{
+		for (size_t i = 0; i != sample_count; ++i)
+			samples[i] = (float)(int16_t)((uint16_t)data[i * 2] | ((uint16_t)data[i * 2 + 1] << 8)) / 32768.0f;
+	}
+	else if (sample_size == 24)
+	{
+		for (size_t i = 0; i != sample_count; ++i)
+			samples[i] = (float)((int32_t)(((uint32_t)data[i * 3] << 8) | ((uint32_t)data[i * 3 + 1] << 16) | ((uint32_t)data[i * 3 + 2] << 24)) >> 8) / 8388608.0f;
+	}
+	else
+	{
+		for (size_t i = 0; i != sample_count; ++i)
+			samples[i] = (float)(int32_t)((uint32_t)data[i * 4] | ((uint32_t)data[i * 4 + 1] << 8) | ((uint32_t)data[i * 4 + 2] << 16) | ((uint32_t)data[i * 4 + 3] << 24)) / 2147483648.0f;
+	}
+}
+
+static int rwl_update_recorder_file_header(rwl_recorder* recorder, size_t frame_count, int padded)
+{
+	uint32_t data_size = (uint32_t)(frame_count * recorder->channel_count * (recorder->sample_size / 8));
+	uint32_t riff_size = (uint32_t)(recorder->header_size - 8) + data_size + (padded ? (data_size & 1) : 0);
+	uint8_t size_data[4];
+	if (fflush(recorder->file))
+		return EIO;
+	for (size_t i = 0; i != 4; ++i)
+		size_data[i] = (uint8_t)(riff_size >> (i * 8));
+	if (fseek(recorder->file, 4, SEEK_SET) || fwrite(size_data, 1, 4, recorder->file) != 4)
+		return EIO;
+	for (size_t i = 0; i != 4; ++i)
+		size_data[i] = (uint8_t)(data_size >> (i * 8));
+	if (fseek(recorder->file, (long)(recorder->header_size - 4), SEEK_SET) || fwrite(size_data, 1, 4, recorder->file) != 4)
+		return EIO;
+	if (fflush(recorder->file) || fseek(recorder->file, 0, SEEK_END))
+		return EIO;
+	return 0;
+}
+
+static int rwl_recorder_thread(void* parameter)
+{
+	rwl_recorder* recorder = (rwl_recorder*)parameter;
+	size_t frame_size = recorder->channel_count * (recorder->sample_size / 8);
+	size_t read_index = recorder->read_index;
+	size_t stored_frame_count = 0;
+	size_t header_frame_count = 0;
+	size_t sleep_time = ((recorder->queue_length / 4) * 1000) / recorder->sample_rate;
+	if (sleep_time > 100)
+		sleep_time = 100;
+	else if (!sleep_time)
+		sleep_time = 1;
+	int error = 0;
+	for (int stop = 0; !stop;)
+	{
+		stop = (int)rwl_atomic_load(&recorder->stop);
+		size_t write_index = rwl_atomic_load(&recorder->write_index);
+		while (read_index != write_index)
 		{
-			if (file_sample_size == 8)
-			{
-				for (size_t i = 0; i != file_sample_count; ++i)
-				{
-					float left_sample = 0.0f;
-					float rigth_sample = 0.0f;
-					for (size_t j = 0; j != file_channel_count; ++j)
-					{
-						float channel_sample = (((float)file_sample_data[i * file_channel_count + j] - 127.5f) / 127.5f);
-						left_sample += channels[j][0] * channel_sample;
-						rigth_sample += channels[j][1] * channel_sample;
-					}
-					left_channel[i] = left_sample;
-					rigth_channel[i] = rigth_sample;
-				}
-			}
-			else if (file_sample_size == 16)
+			size_t queue_offset = read_index & (recorder->queue_length - 1);
+			size_t frame_count = write_index - read_index;
+			if (frame_count > recorder->queue_length - queue_offset)
+				frame_count = recorder->queue_length - queue_offset;
+			if (frame_count > recorder->block_length)
+				frame_count = recorder->block_length;
+			if (!error && frame_count > recorder->maximum_frame_count - stored_frame_count)
 			{
-				int16_t channel_raw_sample;
-				for (size_t i = 0; i != file_sample_count; ++i)
-				{
-					float left_sample = 0.0f;
-					float rigth_sample = 0.0f;
-					for (size_t j = 0; j != file_channel_count; ++j)
-					{
-						*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 2];
-						*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 2 + 1];
-						float channel_sample = ((float)channel_raw_sample / 32768.0f);
-						left_sample += channels[j][0] * channel_sample;
-						rigth_sample += channels[j][1] * channel_sample;
-					}
-					left_channel[i] = left_sample;
-					rigth_channel[i] = rigth_sample;
-				}
+				error = EFBIG;
+				rwl_atomic_store(&recorder->error, (size_t)error);
 			}
-			else if (file_sample_size == 24)
+			if (!error)
 			{
-				int32_t channel_raw_sample;
-				*((uint8_t*)&channel_raw_sample + 3) = 0;
-				for (size_t i = 0; i != file_sample_count; ++i)
+				rwl_encode_samples(recorder->sample_type, recorder->sample_size, frame_count * recorder->channel_count, recorder->queue + queue_offset * recorder->channel_count, recorder->block);
+				if (fwrite(recorder->block, frame_size, frame_count, recorder->file) != frame_count)
 				{
-					float left_sample = 0.0f;
-					float rigth_sample = 0.0f;
-					for (size_t j = 0; j != file_channel_count; ++j)
-					{
-						*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 3];
-						*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 3 + 1];
-						*((uint8_t*)&channel_raw_sample + 2) = file_sample_data[(i * file_channel_count + j) * 3 + 2];
-						float channel_sample = ((channel_raw_sample & 0x800000) ? ((float)(channel_raw_sample - 16777216) / 8388608.0f) : (((float)channel_raw_sample) / 8388608.0f));
-						left_sample += channels[j][0] * channel_sample;
-						rigth_sample += channels[j][1] * channel_sample;
-					}
-					left_channel[i] = left_sample;
-					rigth_channel[i] = rigth_sample;
+					error = EIO;
+					rwl_atomic_store(&recorder->error, (size_t)error);
 				}
-			}
-			else if (file_sample_size == 32)
-			{
-				int32_t channel_raw_sample;
-				for (size_t i = 0; i != file_sample_count; ++i)
+				else
 				{
-					float left_sample = 0.0f;
-					float rigth_sample = 0.0f;
-					for (size_t j = 0; j != file_channel_count; ++j)
-					{
-						*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 4];
-						*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 4 + 1];
-						*((uint8_t*)&channel_raw_sample + 2) = file_sample_data[(i * file_channel_count + j) * 4 + 2];
-						*((uint8_t*)&channel_raw_sample + 3) = file_sample_data[(i * file_channel_count + j) * 4 + 3];
-						float channel_sample = ((float)channel_raw_sample / 2147483648.0f);
-						left_sample += channels[j][0] * channel_sample;
-						rigth_sample += channels[j][1] * channel_sample;
-					}
-					left_channel[i] = left_sample;
-					rigth_channel[i] = rigth_sample;
+					stored_frame_count += frame_count;
+					rwl_atomic_store(&recorder->stored_frame_count, stored_frame_count);
 				}
 			}
-			else
-			{
-				free(file_data);
-				error = ENOSYS;
-				return error;
-			}
+			read_index += frame_count;
+			rwl_atomic_store(&recorder->read_index, read_index);
 		}
-		else if (file_sample_type == 3)
+		int pad = stop && ((stored_frame_count * frame_size) & 1);
+		if (!error && (pad || (stored_frame_count != header_frame_count && (stop || stored_frame_count - header_frame_count >= recorder->sample_rate))))
 		{
-			float channel_raw_sample;
-			for (size_t i = 0; i != file_sample_count; ++i)
+			if ((pad && fputc(0, recorder->file) == EOF) || rwl_update_recorder_file_header(recorder, stored_frame_count, pad))
 			{
-				float left_sample = 0.0f;
-				float rigth_sample = 0.0f;
-				for (size_t j = 0; j != file_channel_count; ++j)
-				{
-					*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 4];
-					*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 4 + 1];
-					*((uint8_t*)&channel_raw_sample + 2) = file_sample_data[(i * file_channel_count + j) * 4 + 2];
-					*((uint8_t*)&channel_raw_sample + 3) = file_sample_data[(i * file_channel_count + j) * 4 + 3];
-					left_sample += channels[j][0] * channel_raw_sample;
-					rigth_sample += channels[j][1] * channel_raw_sample;
-				}
-				left_channel[i] = left_sample;
-				rigth_channel[i] = rigth_sample;
+				error = EIO;
+				rwl_atomic_store(&recorder->error, (size_t)error);
 			}
+			header_frame_count = stored_frame_count;
 		}
-		else
+		if (!stop)
+			rwl_sleep(sleep_time);
+	}
+	return error;
+}
+
+static int rwl_seek_file(FILE* file, uint64_t offset)
+{
+#ifdef _WIN32
+	if (offset > 0x7FFFFFFFFFFFFFFF || _fseeki64(file, (__int64)offset, SEEK_SET))
+		return EIO;
+#else
+	if ((sizeof(off_t) < sizeof(uint64_t) && offset > (uint64_t)0x7FFFFFFF) || fseeko(file, (off_t)offset, SEEK_SET))
+		return EIO;
+#endif
+	return 0;
+}
+
+static int rwl_write_file_at(FILE* file, uint64_t offset, size_t size, const void* data)
+{
+#ifdef _WIN32
+	if (rwl_seek_file(file, offset))
+		return EIO;
+	if (fwrite(data, 1, size, file) != size)
+		return EIO;
+	return 0;
+#else
+	int file_descriptor = fileno(file);
+	for (size_t written = 0; written != size;)
+	{
+		ssize_t write_result = pwrite(file_descriptor, (const void*)((uintptr_t)data + written), size - written, (off_t)(offset + written));
+		if (write_result < 1)
 		{
-			free(file_data);
-			error = ENOSYS;
-			return error;
+			if (write_result == -1 && errno == EINTR)
+				continue;
+			return write_result == -1 ? errno : EIO;
 		}
-		float left_signal_peak = rwl_get_signal_absolute_peak(file_sample_count, left_channel);
-		float right_signal_peak = rwl_get_signal_absolute_peak(file_sample_count, rigth_channel);
-		float signal_peak = left_signal_peak < right_signal_peak ? right_signal_peak : left_signal_peak;
-		if (signal_peak > 0.0009765625f)
+		written += (size_t)write_result;
+	}
+	return 0;
+#endif
+}
+
+static size_t rwl_read_stdio(void* context, void* buffer, size_t size)
+{
+	return fread(buffer, 1, size, (FILE*)context);
+}
+
+static int rwl_seek_stdio(void* context, uint64_t offset)
+{
+	return rwl_seek_file((FILE*)context, offset);
+}
+
+static size_t rwl_write_stdio(void* context, const void* data, size_t size)
+{
+	return fwrite(data, 1, size, (FILE*)context);
+}
+
+static size_t rwl_read_io(const rwl_io* io, void* buffer, size_t size)
+{
+	size_t read = 0;
+	for (size_t read_result = 1; read_result && read != size; read += read_result)
+		read_result = io->read(io->context, (void*)((uintptr_t)buffer + read), size - read);
+	return read;
+}
+
+static int rwl_read_wave_file_header(FILE* file, int* sample_type, size_t* sample_size, size_t* channel_count, uint32_t* channel_mask, size_t* sample_rate, size_t* sample_count, uint64_t* data_offset, size_t* fmt_size, void* fmt_data)
+{
+	rwl_io io = { (void*)file, rwl_read_stdio, rwl_seek_stdio, rwl_write_stdio };
+	return rwl_read_wave_header(&io, sample_type, sample_size, channel_count, channel_mask, sample_rate, sample_count, data_offset, fmt_size, fmt_data);
+}
+
+static int rwl_read_wave_header(const rwl_io* io, int* sample_type, size_t* sample_size, size_t* channel_count, uint32_t* channel_mask, size_t* sample_rate, size_t* sample_count, uint64_t* data_offset, size_t* fmt_size, void* fmt_data)
+{
+	uint8_t riff_data[12];
+	uint8_t fmt_buffer[40];
+	if (io->seek(io->context, 0) || rwl_read_io(io, riff_data, 12) != 12)
+		return EILSEQ;
+	rwl_riff_chunk chunks[3];
+	memcpy(chunks[0].identifier, riff_data, 4);
+	chunks[0].size = (size_t)riff_data[4] | ((size_t)riff_data[5] << 8) | ((size_t)riff_data[6] << 16) | ((size_t)riff_data[7] << 24);
+	chunks[0].data = (const void*)(riff_data + 8);
+	chunks[0].parent = 0;
+	chunks[0].sub_chunk_count = 0;
+	chunks[0].sub_chunks = (void*)(chunks + 1);
+	if (chunks[0].size < 4)
+		return EILSEQ;
+	int fmt_found = 0;
+	int data_found = 0;
+	uint64_t riff_end = 8 + (uint64_t)chunks[0].size;
+	for (uint64_t chunk_offset = 12; !(fmt_found && data_found) && chunk_offset + 8 <= riff_end;)
+	{
+		uint8_t chunk_header[8];
+		if (io->seek(io->context, chunk_offset) || rwl_read_io(io, chunk_header, 8) != 8)
+			return EILSEQ;
+		size_t chunk_size = (size_t)chunk_header[4] | ((size_t)chunk_header[5] << 8) | ((size_t)chunk_header[6] << 16) | ((size_t)chunk_header[7] << 24);
+		if (chunk_offset + 8 + (uint64_t)chunk_size > riff_end)
+			return EILSEQ;
+		if (!fmt_found && !memcmp(chunk_header, "fmt ", 4))
 		{
-			rwl_scale_signal(file_sample_count, left_channel, 1.0f / signal_peak);
-			rwl_scale_signal(file_sample_count, rigth_channel, 1.0f / signal_peak);
+			size_t fmt_read_size = chunk_size < sizeof(fmt_buffer) ? chunk_size : sizeof(fmt_buffer);
+			if (rwl_read_io(io, fmt_buffer, fmt_read_size) != fmt_read_size)
+				return EILSEQ;
+			memcpy(chunks[1 + chunks[0].sub_chunk_count].identifier, chunk_header, 4);
+			chunks[1 + chunks[0].sub_chunk_count].size = chunk_size;
+			chunks[1 + chunks[0].sub_chunk_count].data = (const void*)fmt_buffer;
+			fmt_found = 1;
+		}
+		else if (!data_found && !memcmp(chunk_header, "data", 4))
+		{
+			memcpy(chunks[1 + chunks[0].sub_chunk_count].identifier, chunk_header, 4);
+			chunks[1 + chunks[0].sub_chunk_count].size = chunk_size;
+			chunks[1 + chunks[0].sub_chunk_count].data = 0;
+			*data_offset = chunk_offset + 8;
+			data_found = 1;
+		}
+		else
+		{
+			chunk_offset += 8 + (uint64_t)chunk_size + (uint64_t)(chunk_size & 1);
+			continue;
 		}
+		chunks[1 + chunks[0].sub_chunk_count].parent = (void*)chunks;
+		chunks[1 + chunks[0].sub_chunk_count].sub_chunk_count = 0;
+		chunks[1 + chunks[0].sub_chunk_count].sub_chunks = 0;
+		chunks[0].sub_chunk_count++;
+		chunk_offset += 8 + (uint64_t)chunk_size + (uint64_t)(chunk_size & 1);
 	}
-	else
-	{
-		free(file_data);
-		error = ENOSYS;
+	if (!fmt_found)
+		return ENOENT;
+	if (!data_found)
+		return EILSEQ;
+	uint8_t last_byte;
+	if (io->seek(io->context, riff_end - 1) || rwl_read_io(io, &last_byte, 1) != 1)
+		return EILSEQ;
+	int error = rwl_get_audio_format(chunks, sample_type, sample_size, channel_count, channel_mask, sample_rate, sample_count);
+	if (error)
 		return error;
+	if (fmt_data)
+	{
+		size_t fmt_copy_size = (fmt_buffer[0] == 0xFE && fmt_buffer[1] == 0xFF) ? 40 : 16;
+		memcpy(fmt_data, fmt_buffer, fmt_copy_size);
+		*fmt_size = fmt_copy_size;
 	}
-	free(file_data);
 	return 0;
 }
 
-int rwl_store_wave_file(const char* file_name, size_t sample_rate, size_t sample_count, const float* left_channel, const float* rigth_channel)
+static int rwl_copy_file_data(FILE* destination_file, uint64_t destination_offset, FILE* source_file, uint64_t source_offset, uint64_t size)
 {
-	if (!left_channel && !rigth_channel)
-		return EINVAL;
-	size_t channel_count = (left_channel && rigth_channel) ? 2 : 1;
-	uintptr_t wav = (uintptr_t)malloc(44 + (channel_count * sample_count * 4));
-	if (!wav)
-		return ENOMEM;
-	*(uint8_t*)(wav) = (uint8_t)'R';
-	*(uint8_t*)(wav + 1) = (uint8_t)'I';
+#ifdef _WIN32
+	uint8_t buffer[0x10000];
+	while (size)
+	{
+		size_t block_size = size < (uint64_t)sizeof(buffer) ? (size_t)size : sizeof(buffer);
+		if (rwl_seek_file(source_file, source_offset) || fread(buffer, 1, block_size, source_file) != block_size)
+			return EIO;
+		int error = rwl_write_file_at(destination_file, destination_offset, block_size, buffer);
+		if (error)
+			return error;
+		source_offset += (uint64_t)block_size;
+		destination_offset += (uint64_t)block_size;
+		size -= (uint64_t)block_size;
+	}
+	return 0;
+#else
+	int source_descriptor = fileno(source_file);
+	int destination_descriptor = fileno(destination_file);
+#ifdef __linux__
+	while (size)
+	{
+		off_t source_position = (off_t)source_offset;
+		off_t destination_position = (off_t)destination_offset;
+		ssize_t copy_result = copy_file_range(source_descriptor, &source_position, destination_descriptor, &destination_position, size < (uint64_t)0x40000000 ? (size_t)size : (size_t)0x40000000, 0);
+		if (copy_result == -1 && errno == EINTR)
+			continue;
+		if (copy_result < 1)
+		{
+			if (!copy_result)
+				return EIO;
+			break;
+		}
+		source_offset += (uint64_t)copy_result;
+		destination_offset += (uint64_t)copy_result;
+		size -= (uint64_t)copy_result;
+	}
+	if (size && lseek(destination_descriptor, (off_t)destination_offset, SEEK_SET) != (off_t)-1)
+	{
+		while (size)
+		{
+			off_t source_position = (off_t)source_offset;
+			ssize_t send_result = sendfile(destination_descriptor, source_descriptor, &source_position, size < (uint64_t)0x40000000 ? (size_t)size : (size_t)0x40000000);
+			if (send_result == -1 && errno == EINTR)
+				continue;
+			if (send_result < 1)
+			{
+				if (!send_result)
+					return EIO;
+				break;
+			}
+			source_offset += (uint64_t)send_result;
+			destination_offset += (uint64_t)send_result;
+			size -= (uint64_t)send_result;
+		}
+	}
+#endif
+	uint8_t buffer[0x10000];
+	while (size)
+	{
+		ssize_t read_result = pread(source_descriptor, buffer, size < (uint64_t)sizeof(buffer) ? (size_t)size : sizeof(buffer), (off_t)source_offset);
+		if (read_result == -1 && errno == EINTR)
+			continue;
+		if (read_result < 1)
+			return read_result ? errno : EIO;
+		int error = rwl_write_file_at(destination_file, destination_offset, (size_t)read_result, buffer);
+		if (error)
+			return error;
+		source_offset += (uint64_t)read_result;
+		destination_offset += (uint64_t)read_result;
+		size -= (uint64_t)read_result;
+	}
+	return 0;
+#endif
+}
+
+static int rwl_create_wave_file_from_fmt(const char* file_name, size_t fmt_size, const void* fmt_data, size_t data_size, size_t source_count, FILE** source_files, const uint64_t* source_offsets, const size_t* source_sizes)
+{
+	uint8_t header[68];
+	size_t header_size = 28 + fmt_size;
+	uint32_t riff_size = (uint32_t)(header_size - 8 + data_size + (data_size & 1));
+	memcpy(header, "RIFF", 4);
+	for (size_t i = 0; i != 4; ++i)
+		header[4 + i] = (uint8_t)(riff_size >> (i * 8));
+	memcpy(header + 8, "WAVEfmt ", 8);
+	for (size_t i = 0; i != 4; ++i)
+		header[16 + i] = (uint8_t)(fmt_size >> (i * 8));
+	memcpy(header + 20, fmt_data, fmt_size);
+	memcpy(header + header_size - 8, "data", 4);
+	for (size_t i = 0; i != 4; ++i)
+		header[header_size - 4 + i] = (uint8_t)(data_size >> (i * 8));
+	char* temporal_file_name;
+	FILE* file;
+	int error = rwl_create_temporal_file(file_name, &temporal_file_name, &file);
+	if (error)
+		return error;
+	error = rwl_write_file_at(file, 0, header_size, header);
+	uint64_t offset = (uint64_t)header_size;
+	for (size_t i = 0; !error && i != source_count; ++i)
+	{
+		error = rwl_copy_file_data(file, offset, source_files[i], source_offsets[i], (uint64_t)source_sizes[i]);
+		offset += (uint64_t)source_sizes[i];
+	}
+	if (!error && (data_size & 1))
+	{
+		uint8_t padding = 0;
+		error = rwl_write_file_at(file, offset, 1, &padding);
+	}
+	if (fclose(file) && !error)
+		error = EIO;
+	if (error)
+	{
+		remove(temporal_file_name);
+		free(temporal_file_name);
+		return error;
+	}
+	error = rwl_replace_file(temporal_file_name, file_name);
+	free(temporal_file_name);
+	return error;
+}
+
+static size_t rwl_get_processor_count(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO system_info;
+	GetSystemInfo(&system_info);
+	return system_info.dwNumberOfProcessors ? (size_t)system_info.dwNumberOfProcessors : 1;
+#else
+	long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+	return processor_count > 0 ? (size_t)processor_count : 1;
+#endif
+}
+
+static int rwl_validate_wave_index(size_t size, const void* data, size_t* entry_count, const rwl_wave_index_entry** entries, const char** name_table)
+{
+	const rwl_wave_index_header* header = (const rwl_wave_index_header*)data;
+	if (size < sizeof(rwl_wave_index_header) || memcmp(header->identifier, "RWLI", 4) || header->version != 1)
+		return EILSEQ;
+	if (header->entry_count > (uint64_t)((size - sizeof(rwl_wave_index_header)) / sizeof(rwl_wave_index_entry)) || header->name_table_offset != (uint64_t)sizeof(rwl_wave_index_header) + header->entry_count * (uint64_t)sizeof(rwl_wave_index_entry) || header->name_table_size != (uint64_t)size - header->name_table_offset)
+		return EILSEQ;
+	const rwl_wave_index_entry* index_entries = (const rwl_wave_index_entry*)((uintptr_t)data + sizeof(rwl_wave_index_header));
+	const char* index_name_table = (const char*)((uintptr_t)data + (size_t)header->name_table_offset);
+	for (size_t i = 0; i != (size_t)header->entry_count; ++i)
+		if (index_entries[i].name_offset >= header->name_table_size || (uint64_t)index_entries[i].name_length >= header->name_table_size - index_entries[i].name_offset || index_name_table[index_entries[i].name_offset + index_entries[i].name_length] || (i && strcmp(index_name_table + index_entries[i - 1].name_offset, index_name_table + index_entries[i].name_offset) >= 0))
+			return EILSEQ;
+	*entry_count = (size_t)header->entry_count;
+	*entries = index_entries;
+	*name_table = index_name_table;
+	return 0;
+}
+
+static int rwl_append_indexed_file(rwl_directory_indexer* indexer, int job, char* name, int is_directory, const rwl_wave_index_entry* entry)
+{
+	size_t* count = job ? &indexer->job_count : &indexer->file_count;
+	size_t* capacity = job ? &indexer->job_capacity : &indexer->file_capacity;
+	rwl_indexed_file** files = job ? &indexer->jobs : &indexer->files;
+	rwl_enter_monitor(&indexer->monitor);
+	if (*count == *capacity)
+	{
+		size_t new_capacity = *capacity ? 2 * *capacity : 256;
+		rwl_indexed_file* new_files = (rwl_indexed_file*)realloc(*files, new_capacity * sizeof(rwl_indexed_file));
+		if (!new_files)
+		{
+			rwl_leave_monitor(&indexer->monitor);
+			return ENOMEM;
+		}
+		*files = new_files;
+		*capacity = new_capacity;
+	}
+	(*files)[*count].name = name;
+	(*files)[*count].is_directory = is_directory;
+	(*files)[*count].entry = *entry;
+	(*count)++;
+	if (job)
+		rwl_notify_monitor(&indexer->monitor);
+	rwl_leave_monitor(&indexer->monitor);
+	return 0;
+}
+
+static int rwl_index_directory_entry(rwl_directory_indexer* indexer, const char* directory, const char* name, int is_directory, uint64_t file_size, int64_t modification_time)
+{
+	size_t name_length = strlen(name);
+	if (!is_directory && (name_length < 4 || name[name_length - 4] != '.' || (name[name_length - 3] != 'w' && name[name_length - 3] != 'W') || (name[name_length - 2] != 'a' && name[name_length - 2] != 'A') || (name[name_length - 1] != 'v' && name[name_length - 1] != 'V')))
+		return 0;
+	size_t directory_length = strlen(directory);
+	char* relative_name = (char*)malloc(directory_length + name_length + 2);
+	if (!relative_name)
+		return ENOMEM;
+	memcpy(relative_name, directory, directory_length);
+	if (directory_length)
+		relative_name[directory_length++] = '/';
+	memcpy(relative_name + directory_length, name, name_length + 1);
+	rwl_wave_index_entry entry;
+	memset(&entry, 0, sizeof(rwl_wave_index_entry));
+	entry.file_size = file_size;
+	entry.modification_time = modification_time;
+	if (!is_directory)
+	{
+		size_t first = 0;
+		size_t count = indexer->old_entry_count;
+		while (count)
+		{
+			size_t middle = first + count / 2;
+			int order = strcmp(indexer->old_name_table + indexer->old_entries[middle].name_offset, relative_name);
+			if (order < 0)
+			{
+				first = middle + 1;
+				count -= count / 2 + 1;
+			}
+			else
+				count /= 2;
+		}
+		if (first != indexer->old_entry_count && !strcmp(indexer->old_name_table + indexer->old_entries[first].name_offset, relative_name) && indexer->old_entries[first].file_size == file_size && indexer->old_entries[first].modification_time == modification_time && !indexer->old_entries[first].error)
+		{
+			int error = rwl_append_indexed_file(indexer, 0, relative_name, 0, indexer->old_entries + first);
+			if (error)
+				free(relative_name);
+			return error;
+		}
+	}
+	int error = rwl_append_indexed_file(indexer, 1, relative_name, is_directory, &entry);
+	if (error)
+		free(relative_name);
+	return error;
+}
+
+static int rwl_index_directory_job(rwl_directory_indexer* indexer, rwl_indexed_file* job)
+{
+	size_t name_length = strlen(job->name);
+	char* path = (char*)malloc(indexer->directory_name_length + name_length + 4);
+	if (!path)
+		return ENOMEM;
+	memcpy(path, indexer->directory_name, indexer->directory_name_length);
+	size_t path_length = indexer->directory_name_length;
+	if (name_length)
+	{
+		if (path_length && path[path_length - 1] != '/' && path[path_length - 1] != '\\')
+			path[path_length++] = '/';
+		memcpy(path + path_length, job->name, name_length);
+		path_length += name_length;
+	}
+	path[path_length] = 0;
+	int error = 0;
+	if (!job->is_directory)
+	{
+		FILE* file = fopen(path, "rb");
+		if (file)
+		{
+			int sample_type;
+			size_t sample_size;
+			size_t channel_count;
+			uint32_t channel_mask;
+			size_t sample_rate;
+			size_t sample_count;
+			uint64_t data_offset;
+			int file_error = rwl_read_wave_file_header(file, &sample_type, &sample_size, &channel_count, &channel_mask, &sample_rate, &sample_count, &data_offset, 0, 0);
+			fclose(file);
+			if (!file_error)
+			{
+				job->entry.data_offset = data_offset;
+				job->entry.sample_count = (uint64_t)sample_count;
+				job->entry.sample_rate = (uint32_t)sample_rate;
+				job->entry.channel_mask = channel_mask;
+				job->entry.sample_type = (uint16_t)sample_type;
+				job->entry.sample_size = (uint16_t)sample_size;
+				job->entry.channel_count = (uint16_t)channel_count;
+			}
+			else
+				job->entry.error = (uint32_t)file_error;
+		}
+		else
+			job->entry.error = (uint32_t)errno;
+		error = rwl_append_indexed_file(indexer, 0, job->name, 0, &job->entry);
+		if (!error)
+			job->name = 0;
+		free(path);
+		return error;
+	}
+#ifdef _WIN32
+	memcpy(path + path_length, path_length ? "\\*" : "*", path_length ? 3 : 2);
+	WIN32_FIND_DATAA find_data;
+	HANDLE find_handle = FindFirstFileA(path, &find_data);
+	free(path);
+	if (find_handle == INVALID_HANDLE_VALUE)
+	{
+		DWORD find_error = GetLastError();
+		if (find_error == ERROR_FILE_NOT_FOUND || find_error == ERROR_PATH_NOT_FOUND)
+			return ENOENT;
+		if (find_error == ERROR_ACCESS_DENIED)
+			return EACCES;
+		if (find_error == ERROR_TOO_MANY_OPEN_FILES)
+			return EMFILE;
+		return EIO;
+	}
+	do
+	{
+		if ((find_data.cFileName[0] == '.' && !find_data.cFileName[1]) || (find_data.cFileName[0] == '.' && find_data.cFileName[1] == '.' && !find_data.cFileName[2]))
+			continue;
+		int is_directory = (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? 1 : 0;
+		if (is_directory && (find_data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+			continue;
+		uint64_t file_size = ((uint64_t)find_data.nFileSizeHigh << 32) | (uint64_t)find_data.nFileSizeLow;
+		int64_t modification_time = ((int64_t)(((uint64_t)find_data.ftLastWriteTime.dwHighDateTime << 32) | (uint64_t)find_data.ftLastWriteTime.dwLowDateTime) - (int64_t)116444736000000000) * 100;
+		error = rwl_index_directory_entry(indexer, job->name, find_data.cFileName, is_directory, file_size, modification_time);
+	} while (!error && FindNextFileA(find_handle, &find_data));
+	FindClose(find_handle);
+#else
+	DIR* directory = opendir(path);
+	if (!directory)
+	{
+		error = errno;
+		free(path);
+		return error;
+	}
+	for (struct dirent* directory_entry = readdir(directory); !error && directory_entry; directory_entry = readdir(directory))
+	{
+		if ((directory_entry->d_name[0] == '.' && !directory_entry->d_name[1]) || (directory_entry->d_name[0] == '.' && directory_entry->d_name[1] == '.' && !directory_entry->d_name[2]))
+			continue;
+		size_t entry_name_length = strlen(directory_entry->d_name);
+		char* entry_path = (char*)malloc(path_length + entry_name_length + 2);
+		if (!entry_path)
+		{
+			error = ENOMEM;
+			break;
+		}
+		memcpy(entry_path, path, path_length);
+		entry_path[path_length] = '/';
+		memcpy(entry_path + path_length + 1, directory_entry->d_name, entry_name_length + 1);
+		struct stat entry_status;
+		int status_error = lstat(entry_path, &entry_status);
+		if (!status_error && S_ISLNK(entry_status.st_mode))
+			status_error = stat(entry_path, &entry_status) || S_ISDIR(entry_status.st_mode);
+		free(entry_path);
+		if (status_error || (!S_ISDIR(entry_status.st_mode) && !S_ISREG(entry_status.st_mode)))
+			continue;
+#ifdef __APPLE__
+		int64_t modification_time = (int64_t)entry_status.st_mtimespec.tv_sec * 1000000000 + (int64_t)entry_status.st_mtimespec.tv_nsec;
+#else
+		int64_t modification_time = (int64_t)entry_status.st_mtim.tv_sec * 1000000000 + (int64_t)entry_status.st_mtim.tv_nsec;
+#endif
+		error = rwl_index_directory_entry(indexer, job->name, directory_entry->d_name, S_ISDIR(entry_status.st_mode), (uint64_t)entry_status.st_size, modification_time);
+	}
+	closedir(directory);
+	free(path);
+#endif
+	return error;
+}
+
+static int rwl_directory_indexer_thread(void* parameter)
+{
+	rwl_directory_indexer* indexer = (rwl_directory_indexer*)parameter;
+	rwl_enter_monitor(&indexer->monitor);
+	for (;;)
+	{
+		while (!indexer->error && !indexer->job_count && indexer->active_thread_count)
+			rwl_wait_monitor(&indexer->monitor);
+		if (indexer->error || !indexer->job_count)
+			break;
+		rwl_indexed_file job = indexer->jobs[--indexer->job_count];
+		indexer->active_thread_count++;
+		rwl_leave_monitor(&indexer->monitor);
+		int error = rwl_index_directory_job(indexer, &job);
+		free(job.name);
+		rwl_enter_monitor(&indexer->monitor);
+		indexer->active_thread_count--;
+		if (error && !indexer->error)
+			indexer->error = error;
+		rwl_notify_monitor(&indexer->monitor);
+	}
+	rwl_leave_monitor(&indexer->monitor);
+	return 0;
+}
+
+static int rwl_compare_indexed_files(const void* a, const void* b)
+{
+	return strcmp(((const rwl_indexed_file*)a)->name, ((const rwl_indexed_file*)b)->name);
+}
+
+static int rwl_parallel_store_peak_thread(void* parameter)
+{
+	rwl_parallel_store* store = (rwl_parallel_store*)parameter;
+	for (;;)
+	{
+		rwl_enter_monitor(&store->monitor);
+		size_t thread_index = store->peak_thread_index;
+		if (thread_index != store->thread_count)
+			store->peak_thread_index++;
+		rwl_leave_monitor(&store->monitor);
+		if (thread_index == store->thread_count)
+			break;
+		size_t first_sample = (store->sample_count / store->thread_count) * thread_index;
+		size_t sample_count = thread_index + 1 != store->thread_count ? store->sample_count / store->thread_count : store->sample_count - first_sample;
+		float peak = 0.0f;
+		if (store->left_channel)
+			peak = rwl_get_signal_absolute_peak(sample_count, store->left_channel + first_sample);
+		if (store->rigth_channel)
+		{
+			float rigth_peak = rwl_get_signal_absolute_peak(sample_count, store->rigth_channel + first_sample);
+			if (rigth_peak > peak)
+				peak = rigth_peak;
+		}
+		store->thread_peaks[thread_index] = peak;
+	}
+	return 0;
+}
+
+static void rwl_convert_parallel_store_block(rwl_parallel_store* store, size_t block_index)
+{
+	size_t first_sample = block_index * store->block_length;
+	size_t sample_count = store->sample_count - first_sample < store->block_length ? store->sample_count - first_sample : store->block_length;
+	float* slot = store->slots + (block_index % store->slot_count) * store->block_length * store->channel_count;
+	if (store->channel_count == 1)
+		memcpy(slot, (store->left_channel ? store->left_channel : store->rigth_channel) + first_sample, sample_count * sizeof(float));
+	else
+		for (size_t i = 0; i != sample_count; ++i)
+		{
+			slot[2 * i] = store->left_channel[first_sample + i];
+			slot[2 * i + 1] = store->rigth_channel[first_sample + i];
+		}
+	if (store->multiplier != 1.0f)
+		rwl_scale_signal(sample_count * store->channel_count, slot, store->multiplier);
+}
+
+static int rwl_parallel_store_convert_thread(void* parameter)
+{
+	rwl_parallel_store* store = (rwl_parallel_store*)parameter;
+	rwl_enter_monitor(&store->monitor);
+	for (;;)
+	{
+		while (!store->abort && store->next_block != store->block_count && store->next_block >= store->written_block_count + store->slot_count)
+			rwl_wait_monitor(&store->monitor);
+		if (store->abort || store->next_block == store->block_count)
+			break;
+		size_t block_index = store->next_block++;
+		rwl_leave_monitor(&store->monitor);
+		rwl_convert_parallel_store_block(store, block_index);
+		rwl_enter_monitor(&store->monitor);
+		store->ready_slots[block_index % store->slot_count] = 1;
+		rwl_notify_monitor(&store->monitor);
+	}
+	rwl_leave_monitor(&store->monitor);
+	return 0;
+}
+
+static void rwl_run_parallel_store_threads(rwl_parallel_store* store, int (*procedure)(void* parameter), rwl_thread* threads)
+{
+	size_t thread_count = 0;
+	while (thread_count != store->thread_count - 1)
+	{
+		if (rwl_create_thread(threads + thread_count, procedure, store))
+			break;
+		++thread_count;
+	}
+	procedure(store);
+	while (thread_count)
+		rwl_wait_thread(threads + --thread_count);
+}
+
+static void rwl_abort_transcoder(rwl_transcoder* transcoder)
+{
+	rwl_abort_block_queue(&transcoder->source_free_queue);
+	rwl_abort_block_queue(&transcoder->source_full_queue);
+	rwl_abort_block_queue(&transcoder->free_queue);
+	rwl_abort_block_queue(&transcoder->full_queue);
+}
+
+static int rwl_transcoder_convert_thread(void* parameter)
+{
+	rwl_transcoder* transcoder = (rwl_transcoder*)parameter;
+	for (;;)
+	{
+		void* source_block;
+		size_t frame_count;
+		void* block;
+		size_t block_length;
+		int error = rwl_pop_block(&transcoder->source_full_queue, &source_block, &frame_count);
+		if (!error)
+			error = rwl_pop_block(&transcoder->free_queue, &block, &block_length);
+		if (error)
+		{
+			rwl_abort_transcoder(transcoder);
+			return error;
+		}
+		if (!frame_count)
+		{
+			rwl_push_block(&transcoder->full_queue, block, 0);
+			return 0;
+		}
+		rwl_decode_samples(transcoder->source_sample_type, transcoder->source_sample_size, frame_count * transcoder->source_channel_count, source_block, transcoder->source_samples);
+		rwl_push_block(&transcoder->source_free_queue, source_block, 0);
+		if (transcoder->mix_matrix)
+		{
+			for (size_t i = 0; i != frame_count; ++i)
+				for (size_t j = 0; j != transcoder->channel_count; ++j)
+				{
+					float sample = 0.0f;
+					for (size_t k = 0; k != transcoder->source_channel_count; ++k)
+						sample += transcoder->mix_matrix[j * transcoder->source_channel_count + k] * transcoder->source_samples[i * transcoder->source_channel_count + k];
+					transcoder->samples[i * transcoder->channel_count + j] = sample;
+				}
+			rwl_encode_samples(transcoder->sample_type, transcoder->sample_size, frame_count * transcoder->channel_count, transcoder->samples, block);
+		}
+		else
+			rwl_encode_samples(transcoder->sample_type, transcoder->sample_size, frame_count * transcoder->channel_count, transcoder->source_samples, block);
+		rwl_push_block(&transcoder->full_queue, block, frame_count);
+	}
+}
+
+static int rwl_transcoder_write_thread(void* parameter)
+{
+	rwl_transcoder* transcoder = (rwl_transcoder*)parameter;
+	size_t frame_size = transcoder->channel_count * (transcoder->sample_size / 8);
+	for (;;)
+	{
+		void* block;
+		size_t frame_count;
+		int error = rwl_pop_block(&transcoder->full_queue, &block, &frame_count);
+		if (error)
+		{
+			rwl_abort_transcoder(transcoder);
+			return error;
+		}
+		if (!frame_count)
+			return 0;
+		if (fwrite(block, frame_size, frame_count, transcoder->file) != frame_count)
+		{
+			rwl_abort_transcoder(transcoder);
+			return EIO;
+		}
+		rwl_push_block(&transcoder->free_queue, block, 0);
+	}
+}
+
+int rwl_create_recorder(const char* file_name, size_t sample_rate, size_t channel_count, int sample_type, size_t sample_size, size_t queue_length, rwl_recorder** recorder)
+{
+	if (!sample_rate || sample_rate > 0xFFFFFFFF || !channel_count || channel_count > 18 || !rwl_is_supported_sample_format(sample_type, sample_size) || !queue_length || queue_length > (((size_t)~0) >> 1) / (channel_count * sizeof(float)))
+		return EINVAL;
+	size_t queue_length_power_of_two = 1;
+	while (queue_length_power_of_two < queue_length)
+		queue_length_power_of_two <<= 1;
+	size_t block_length = queue_length_power_of_two < 4096 ? queue_length_power_of_two : 4096;
+	rwl_recorder* new_recorder = (rwl_recorder*)malloc(sizeof(rwl_recorder));
+	if (!new_recorder)
+		return ENOMEM;
+	new_recorder->queue = (float*)malloc(queue_length_power_of_two * channel_count * sizeof(float));
+	if (!new_recorder->queue)
+	{
+		free(new_recorder);
+		return ENOMEM;
+	}
+	new_recorder->block = malloc(block_length * channel_count * (sample_size / 8));
+	if (!new_recorder->block)
+	{
+		free(new_recorder->queue);
+		free(new_recorder);
+		return ENOMEM;
+	}
+	new_recorder->sample_type = sample_type;
+	new_recorder->sample_size = sample_size;
+	new_recorder->channel_count = channel_count;
+	new_recorder->sample_rate = sample_rate;
+	new_recorder->queue_length = queue_length_power_of_two;
+	new_recorder->block_length = block_length;
+	new_recorder->write_index = 0;
+	new_recorder->read_index = 0;
+	new_recorder->stored_frame_count = 0;
+	new_recorder->lost_frame_count = 0;
+	new_recorder->overrun_count = 0;
+	new_recorder->stop = 0;
+	new_recorder->error = 0;
+	uint8_t header[68];
+	new_recorder->header_size = rwl_create_wave_header(sample_type, sample_size, channel_count, rwl_get_default_channel_mask(channel_count), sample_rate, 0, header);
+	new_recorder->maximum_frame_count = ((size_t)0xFFFFFFFE - new_recorder->header_size) / (channel_count * (sample_size / 8));
+	new_recorder->file = fopen(file_name, "wb");
+	if (!new_recorder->file)
+	{
+		int error = errno;
+		free(new_recorder->block);
+		free(new_recorder->queue);
+		free(new_recorder);
+		return error;
+	}
+	if (fwrite(header, 1, new_recorder->header_size, new_recorder->file) != new_recorder->header_size || fflush(new_recorder->file))
+	{
+		fclose(new_recorder->file);
+		remove(file_name);
+		free(new_recorder->block);
+		free(new_recorder->queue);
+		free(new_recorder);
+		return EIO;
+	}
+	int error = rwl_create_thread(&new_recorder->thread, rwl_recorder_thread, new_recorder);
+	if (error)
+	{
+		fclose(new_recorder->file);
+		remove(file_name);
+		free(new_recorder->block);
+		free(new_recorder->queue);
+		free(new_recorder);
+		return error;
+	}
+	*recorder = new_recorder;
+	return 0;
+}
+
+size_t rwl_write_recorder(rwl_recorder* recorder, size_t frame_count, const float* frames)
+{
+	size_t write_index = recorder->write_index;
+	size_t free_length = recorder->queue_length - (write_index - rwl_atomic_load(&recorder->read_index));
+	size_t queued_frame_count = frame_count < free_length ? frame_count : free_length;
+	if (queued_frame_count != frame_count)
+	{
+		rwl_atomic_store(&recorder->lost_frame_count, recorder->lost_frame_count + (frame_count - queued_frame_count));
+		rwl_atomic_store(&recorder->overrun_count, recorder->overrun_count + 1);
+	}
+	size_t queue_offset = write_index & (recorder->queue_length - 1);
+	size_t first_frame_count = recorder->queue_length - queue_offset;
+	if (first_frame_count > queued_frame_count)
+		first_frame_count = queued_frame_count;
+	memcpy(recorder->queue + queue_offset * recorder->channel_count, frames, first_frame_count * recorder->channel_count * sizeof(float));
+	memcpy(recorder->queue, frames + first_frame_count * recorder->channel_count, (queued_frame_count - first_frame_count) * recorder->channel_count * sizeof(float));
+	rwl_atomic_store(&recorder->write_index, write_index + queued_frame_count);
+	return queued_frame_count;
+}
+
+int rwl_get_recorder_status(rwl_recorder* recorder, size_t* stored_frame_count, size_t* lost_frame_count, size_t* overrun_count)
+{
+	if (stored_frame_count)
+		*stored_frame_count = rwl_atomic_load(&recorder->stored_frame_count);
+	if (lost_frame_count)
+		*lost_frame_count = rwl_atomic_load(&recorder->lost_frame_count);
+	if (overrun_count)
+		*overrun_count = rwl_atomic_load(&recorder->overrun_count);
+	return (int)rwl_atomic_load(&recorder->error);
+}
+
+int rwl_close_recorder(rwl_recorder* recorder)
+{
+	rwl_atomic_store(&recorder->stop, 1);
+	int error = rwl_wait_thread(&recorder->thread);
+	if (fclose(recorder->file) && !error)
+		error = EIO;
+	free(recorder->block);
+	free(recorder->queue);
+	free(recorder);
+	return error;
+}
+
+static float rwl_get_mean_square(int sample_type, size_t sample_size, size_t sample_count, const void* data)
+{
+	const uint8_t* samples = (const uint8_t*)data;
+	size_t i = 0;
+	float sum = 0.0f;
+#ifdef RWL_SSE2
+	__m128 vector_sum = _mm_setzero_ps();
+	if (sample_type == RWL_SAMPLE_TYPE_FLOAT)
+	{
+		for (; sample_count - i >= 4; i += 4)
+		{
+			__m128 vector = _mm_loadu_ps((const float*)(samples + i * 4));
+			vector_sum = _mm_add_ps(vector_sum, _mm_mul_ps(vector, vector));
+		}
+	}
+	else if (sample_size == 16)
+	{
+		const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+		for (; sample_count - i >= 8; i += 8)
+		{
+			__m128i vector = _mm_loadu_si128((const __m128i*)(samples + i * 2));
+			__m128 low = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(vector, vector), 16)), scale);
+			__m128 high = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(vector, vector), 16)), scale);
+			vector_sum = _mm_add_ps(vector_sum, _mm_add_ps(_mm_mul_ps(low, low), _mm_mul_ps(high, high)));
+		}
+	}
+	else if (sample_size == 8)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 offset = _mm_set1_ps(127.5f);
+		const __m128 scale = _mm_set1_ps(1.0f / 127.5f);
+		for (; sample_count - i >= 16; i += 16)
+		{
+			__m128i vector = _mm_loadu_si128((const __m128i*)(samples + i));
+			__m128i low = _mm_unpacklo_epi8(vector, zero);
+			__m128i high = _mm_unpackhi_epi8(vector, zero);
+			__m128i words[4] = { _mm_unpacklo_epi16(low, zero), _mm_unpackhi_epi16(low, zero), _mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero) };
+			for (size_t j = 0; j != 4; ++j)
+			{
+				__m128 part = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(words[j]), offset), scale);
+				vector_sum = _mm_add_ps(vector_sum, _mm_mul_ps(part, part));
+			}
+		}
+	}
+	else if (sample_size == 24)
+	{
+		const __m128 scale = _mm_set1_ps(1.0f / 8388608.0f);
+		for (; sample_count - i >= 6; i += 4)
+		{
+			__m128i vector = _mm_loadu_si128((const __m128i*)(samples + i * 3));
+			__m128i first = _mm_unpacklo_epi32(vector, _mm_srli_si128(vector, 3));
+			__m128i second = _mm_unpacklo_epi32(_mm_srli_si128(vector, 6), _mm_srli_si128(vector, 9));
+			__m128i words = _mm_srai_epi32(_mm_slli_epi32(_mm_unpacklo_epi64(first, second), 8), 8);
+			__m128 part = _mm_mul_ps(_mm_cvtepi32_ps(words), scale);
+			vector_sum = _mm_add_ps(vector_sum, _mm_mul_ps(part, part));
+		}
+	}
+	else if (sample_size == 32)
+	{
+		const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+		for (; sample_count - i >= 4; i += 4)
+		{
+			__m128 vector = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(samples + i * 4))), scale);
+			vector_sum = _mm_add_ps(vector_sum, _mm_mul_ps(vector, vector));
+		}
+	}
+	float vector_sums[4];
+	_mm_storeu_ps(vector_sums, vector_sum);
+	sum = (vector_sums[0] + vector_sums[1]) + (vector_sums[2] + vector_sums[3]);
+#endif
+	if (i != sample_count)
+	{
+		float tail[64];
+		while (i != sample_count)
+		{
+			size_t tail_count = sample_count - i < 64 ? sample_count - i : 64;
+			rwl_decode_samples(sample_type, sample_size, tail_count, samples + i * (sample_size / 8), tail);
+			for (size_t j = 0; j != tail_count; ++j)
+				sum += tail[j] * tail[j];
+			i += tail_count;
+		}
+	}
+	return sample_count ? sum / (float)sample_count : 0.0f;
+}
+
+static int rwl_find_voice_activity(int sample_type, size_t sample_size, size_t channel_count, size_t sample_count, const void* data, float threshold, size_t block_length, size_t* first_sample, size_t* last_sample, uint8_t** block_activity)
+{
+	size_t block_count = (sample_count / block_length) + ((sample_count % block_length) ? 1 : 0);
+	uint8_t* activity = (uint8_t*)malloc(block_count ? block_count : 1);
+	if (!activity)
+		return ENOMEM;
+	size_t frame_size = channel_count * (sample_size / 8);
+	float threshold_square = threshold * threshold;
+	size_t first_block = block_count;
+	size_t last_block = 0;
+	for (size_t i = 0; i != block_count; ++i)
+	{
+		size_t block_sample_count = (i + 1 != block_count || !(sample_count % block_length)) ? block_length : (sample_count % block_length);
+		activity[i] = rwl_get_mean_square(sample_type, sample_size, block_sample_count * channel_count, (const void*)((uintptr_t)data + i * block_length * frame_size)) >= threshold_square ? 1 : 0;
+		if (activity[i])
+		{
+			if (first_block == block_count)
+				first_block = i;
+			last_block = i;
+		}
+	}
+	if (first_block == block_count)
+	{
+		*first_sample = 0;
+		*last_sample = 0;
+	}
+	else
+	{
+		*first_sample = first_block * block_length;
+		*last_sample = (last_block + 1) * block_length < sample_count ? (last_block + 1) * block_length : sample_count;
+	}
+	*block_activity = activity;
+	return 0;
+}
+
+static int rwl_decode_wave(size_t file_size, const void* file_data, float trim_threshold, size_t trim_block_length, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel, size_t* trim_offset, uint8_t* voice_activity, uint64_t* data_hash)
+{
+	rwl_riff_chunk* file_riff;
+	int error = rwl_create_riff_tree(file_size, file_data, &file_riff);
+	if (error)
+		return error;
+	int file_sample_type;
+	size_t file_sample_size;
+	size_t file_channel_count;
+	uint32_t file_channel_mask;
+	size_t file_sample_rate;
+	size_t file_sample_count;
+	error = rwl_get_audio_format(file_riff, &file_sample_type, &file_sample_size, &file_channel_count, &file_channel_mask, &file_sample_rate, &file_sample_count);
+	if (error)
+	{
+		free(file_riff);
+		return error;
+	}
+	if (!((file_sample_type == 1) && (file_sample_size == 8 || file_sample_size == 16 || file_sample_size == 24 || file_sample_size == 32)) && !((file_sample_type == 3) && (file_sample_size == 32)))
+	{
+		free(file_riff);
+		error = ENOTSUP;
+		return error;
+	}
+	size_t file_sample_offset = 0;
+	uint8_t* file_block_activity = 0;
+	if (trim_block_length)
+	{
+		size_t file_last_sample;
+		error = rwl_find_voice_activity(file_sample_type, file_sample_size, file_channel_count, file_sample_count, rwl_get_riff_chunk(file_riff, "RIFFdata")->data, trim_threshold, trim_block_length, &file_sample_offset, &file_last_sample, &file_block_activity);
+		if (error)
+		{
+			free(file_riff);
+			return error;
+		}
+		file_sample_count = file_last_sample - file_sample_offset;
+		*trim_offset = file_sample_offset;
+	}
+	size_t channel_count = (left_channel ? (size_t)1 : (size_t)0) + (rigth_channel ? (size_t)1 : (size_t)0);
+	rwl_riff_chunk* wave_data = rwl_get_riff_chunk(file_riff, "RIFFdata");
+	if (!channel_count)
+	{
+		if (data_hash)
+		{
+			rwl_hash_state hash;
+			rwl_begin_hash(&hash);
+			rwl_update_hash(&hash, wave_data->data, wave_data->size);
+			*data_hash = rwl_finish_hash(&hash);
+		}
+		if (file_block_activity && voice_activity)
+			memcpy(voice_activity, file_block_activity + file_sample_offset / trim_block_length, (file_sample_count / trim_block_length) + ((file_sample_count % trim_block_length) ? 1 : 0));
+		free(file_block_activity);
+		free(file_riff);
+		*sample_rate = file_sample_rate;
+		*sample_count = file_sample_count;
+		return 0;
+	}
+	if (channel_count == 2)
+	{
+		uint32_t file_channel_mask_channel_count = 0;
+		for (uint32_t i = 0; i != 32; ++i)
+			if (file_channel_mask & (1 << i))
+				++file_channel_mask_channel_count;
+		if (file_channel_mask_channel_count != file_channel_count)
+		{
+			free(file_block_activity);
+			free(file_riff);
+			error = ENOTSUP;
+			return error;
+		}
+	}
+	if (*sample_count < file_sample_count)
+	{
+		free(file_block_activity);
+		free(file_riff);
+		*sample_rate = file_sample_rate;
+		*sample_count = file_sample_count;
+		return ENOBUFS;
+	}
+	if (file_block_activity)
+	{
+		if (voice_activity)
+			memcpy(voice_activity, file_block_activity + file_sample_offset / trim_block_length, (file_sample_count / trim_block_length) + ((file_sample_count % trim_block_length) ? 1 : 0));
+		free(file_block_activity);
+	}
+	size_t file_frame_size = file_channel_count * (file_sample_size / 8);
+	const uint8_t* file_sample_data = (const uint8_t*)wave_data->data + file_sample_offset * file_frame_size;
+	rwl_hash_state hash;
+	size_t hash_block_length = file_sample_count;
+	if (data_hash)
+	{
+		rwl_begin_hash(&hash);
+		rwl_update_hash(&hash, wave_data->data, file_sample_offset * file_frame_size);
+		hash_block_length = ((0x8000 / file_frame_size) + 31) & ~(size_t)31;
+	}
+	if (channel_count == 1)
+	{
+		float* samples = left_channel ? left_channel : rigth_channel;
+		for (size_t block_begin = 0, block_end; block_begin != file_sample_count; block_begin = block_end)
+		{
+			block_end = (file_sample_count - block_begin > hash_block_length) ? block_begin + hash_block_length : file_sample_count;
+			if (data_hash)
+				rwl_update_hash(&hash, file_sample_data + block_begin * file_frame_size, (block_end - block_begin) * file_frame_size);
+			if (file_sample_type == 1)
+			{
+				if (file_sample_size == 8)
+				{
+					for (size_t i = block_begin; i != block_end; ++i)
+					{
+						float sample = 0.0f;
+						for (size_t j = 0; j != file_channel_count; ++j)
+							sample += ((float)file_sample_data[i * file_channel_count + j] - 127.5f) / 127.5f;
+						samples[i] = sample;
+					}
+				}
+				else if (file_sample_size == 16)
+				{
+					int16_t channel_raw_sample;
+					for (size_t i = block_begin; i != block_end; ++i)
+					{
+						float sample = 0.0f;
+						for (size_t j = 0; j != file_channel_count; ++j)
+						{
+							*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 2];
+							*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 2 + 1];
+							sample += (float)channel_raw_sample / 32768.0f;
+						}
+						samples[i] = sample;
+					}
+				}
+				else if (file_sample_size == 24)
+				{
+					int32_t channel_raw_sample;
+					*((uint8_t*)&channel_raw_sample + 3) = 0;
+					for (size_t i = block_begin; i != block_end; ++i)
+					{
+						float sample = 0.0f;
+						for (size_t j = 0; j != file_channel_count; ++j)
+						{
+							*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 3];
+							*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 3 + 1];
+							*((uint8_t*)&channel_raw_sample + 2) = file_sample_data[(i * file_channel_count + j) * 3 + 2];
+							sample += (channel_raw_sample & 0x800000) ? ((float)(channel_raw_sample - 16777216) / 8388608.0f) : (((float)channel_raw_sample) / 8388608.0f);
+						}
+						samples[i] = sample;
+					}
+				}
+				else if (file_sample_size == 32)
+				{
+					int32_t channel_raw_sample;
+					for (size_t i = block_begin; i != block_end; ++i)
+					{
+						float sample = 0.0f;
+						for (size_t j = 0; j != file_channel_count; ++j)
+						{
+							*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 4];
+							*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 4 + 1];
+							*((uint8_t*)&channel_raw_sample + 2) = file_sample_data[(i * file_channel_count + j) * 4 + 2];
+							*((uint8_t*)&channel_raw_sample + 3) = file_sample_data[(i * file_channel_count + j) * 4 + 3];
+							sample += (float)channel_raw_sample / 2147483648.0f;
+						}
+						samples[i] = sample;
+					}
+				}
+				else
+				{
+					free(file_riff);
+					error = ENOSYS;
+					return error;
+				}
+			}
+			else if (file_sample_type == 3)
+			{
+				float channel_sample;
+				for (size_t i = block_begin; i != block_end; ++i)
+				{
+					float sample = 0.0f;
+					for (size_t j = 0; j != file_channel_count; ++j)
+					{
+						*((uint8_t*)&channel_sample) = file_sample_data[(i * file_channel_count + j) * 4];
+						*((uint8_t*)&channel_sample + 1) = file_sample_data[(i * file_channel_count + j) * 4 + 1];
+						*((uint8_t*)&channel_sample + 2) = file_sample_data[(i * file_channel_count + j) * 4 + 2];
+						*((uint8_t*)&channel_sample + 3) = file_sample_data[(i * file_channel_count + j) * 4 + 3];
+						sample += channel_sample;
+					}
+					samples[i] = sample;
+				}
+			}
+			else
+			{
+				free(file_riff);
+				error = ENOSYS;
+				return error;
+			}
+		}
+		float signal_peak = rwl_get_signal_absolute_peak(file_sample_count, samples);
+		if (signal_peak > 0.0009765625f)
+			rwl_scale_signal(file_sample_count, samples, 1.0f / signal_peak);
+	}
+	else if (channel_count == 2)
+	{
+		float channels[18][2];
+		for (size_t channel_index = 0, bit_index = 0; channel_index != file_channel_count; ++bit_index, ++channel_index)
+		{
+			while (!(file_channel_mask & (1 << (uint32_t)bit_index)))
+				++bit_index;
+			channels[channel_index][0] = rwl_stereo_channel_multipliers[bit_index][0];
+			channels[channel_index][1] = rwl_stereo_channel_multipliers[bit_index][1];
+		}
+		for (size_t block_begin = 0, block_end; block_begin != file_sample_count; block_begin = block_end)
+		{
+			block_end = (file_sample_count - block_begin > hash_block_length) ? block_begin + hash_block_length : file_sample_count;
+			if (data_hash)
+				rwl_update_hash(&hash, file_sample_data + block_begin * file_frame_size, (block_end - block_begin) * file_frame_size);
+			if (file_sample_type == 1)
+			{
+				if (file_sample_size == 8)
+				{
+					for (size_t i = block_begin; i != block_end; ++i)
+					{
+						float left_sample = 0.0f;
+						float rigth_sample = 0.0f;
+						for (size_t j = 0; j != file_channel_count; ++j)
+						{
+							float channel_sample = (((float)file_sample_data[i * file_channel_count + j] - 127.5f) / 127.5f);
+							left_sample += channels[j][0] * channel_sample;
+							rigth_sample += channels[j][1] * channel_sample;
+						}
+						left_channel[i] = left_sample;
+						rigth_channel[i] = rigth_sample;
+					}
+				}
+				else if (file_sample_size == 16)
+				{
+					int16_t channel_raw_sample;
+					for (size_t i = block_begin; i != block_end; ++i)
+					{
+						float left_sample = 0.0f;
+						float rigth_sample = 0.0f;
+						for (size_t j = 0; j != file_channel_count; ++j)
+						{
+							*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 2];
+							*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 2 + 1];
+							float channel_sample = ((float)channel_raw_sample / 32768.0f);
+							left_sample += channels[j][0] * channel_sample;
+							rigth_sample += channels[j][1] * channel_sample;
+						}
+						left_channel[i] = left_sample;
+						rigth_channel[i] = rigth_sample;
+					}
+				}
+				else if (file_sample_size == 24)
+				{
+					int32_t channel_raw_sample;
+					*((uint8_t*)&channel_raw_sample + 3) = 0;
+					for (size_t i = block_begin; i != block_end; ++i)
+					{
+						float left_sample = 0.0f;
+						float rigth_sample = 0.0f;
+						for (size_t j = 0; j != file_channel_count; ++j)
+						{
+							*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 3];
+							*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 3 + 1];
+							*((uint8_t*)&channel_raw_sample + 2) = file_sample_data[(i * file_channel_count + j) * 3 + 2];
+							float channel_sample = ((channel_raw_sample & 0x800000) ? ((float)(channel_raw_sample - 16777216) / 8388608.0f) : (((float)channel_raw_sample) / 8388608.0f));
+							left_sample += channels[j][0] * channel_sample;
+							rigth_sample += channels[j][1] * channel_sample;
+						}
+						left_channel[i] = left_sample;
+						rigth_channel[i] = rigth_sample;
+					}
+				}
+				else if (file_sample_size == 32)
+				{
+					int32_t channel_raw_sample;
+					for (size_t i = block_begin; i != block_end; ++i)
+					{
+						float left_sample = 0.0f;
+						float rigth_sample = 0.0f;
+						for (size_t j = 0; j != file_channel_count; ++j)
+						{
+							*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 4];
+							*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 4 + 1];
+							*((uint8_t*)&channel_raw_sample + 2) = file_sample_data[(i * file_channel_count + j) * 4 + 2];
+							*((uint8_t*)&channel_raw_sample + 3) = file_sample_data[(i * file_channel_count + j) * 4 + 3];
+							float channel_sample = ((float)channel_raw_sample / 2147483648.0f);
+							left_sample += channels[j][0] * channel_sample;
+							rigth_sample += channels[j][1] * channel_sample;
+						}
+						left_channel[i] = left_sample;
+						rigth_channel[i] = rigth_sample;
+					}
+				}
+				else
+				{
+					free(file_riff);
+					error = ENOSYS;
+					return error;
+				}
+			}
+			else if (file_sample_type == 3)
+			{
+				float channel_raw_sample;
+				for (size_t i = block_begin; i != block_end; ++i)
+				{
+					float left_sample = 0.0f;
+					float rigth_sample = 0.0f;
+					for (size_t j = 0; j != file_channel_count; ++j)
+					{
+						*((uint8_t*)&channel_raw_sample) = file_sample_data[(i * file_channel_count + j) * 4];
+						*((uint8_t*)&channel_raw_sample + 1) = file_sample_data[(i * file_channel_count + j) * 4 + 1];
+						*((uint8_t*)&channel_raw_sample + 2) = file_sample_data[(i * file_channel_count + j) * 4 + 2];
+						*((uint8_t*)&channel_raw_sample + 3) = file_sample_data[(i * file_channel_count + j) * 4 + 3];
+						left_sample += channels[j][0] * channel_raw_sample;
+						rigth_sample += channels[j][1] * channel_raw_sample;
+					}
+					left_channel[i] = left_sample;
+					rigth_channel[i] = rigth_sample;
+				}
+			}
+			else
+			{
+				free(file_riff);
+				error = ENOSYS;
+				return error;
+			}
+		}
+		float left_signal_peak = rwl_get_signal_absolute_peak(file_sample_count, left_channel);
+		float right_signal_peak = rwl_get_signal_absolute_peak(file_sample_count, rigth_channel);
+		float signal_peak = left_signal_peak < right_signal_peak ? right_signal_peak : left_signal_peak;
+		if (signal_peak > 0.0009765625f)
+		{
+			rwl_scale_signal(file_sample_count, left_channel, 1.0f / signal_peak);
+			rwl_scale_signal(file_sample_count, rigth_channel, 1.0f / signal_peak);
+		}
+	}
+	else
+	{
+		free(file_riff);
+		error = ENOSYS;
+		return error;
+	}
+	if (data_hash)
+	{
+		const uint8_t* hashed_data_end = file_sample_data + file_sample_count * file_frame_size;
+		rwl_update_hash(&hash, hashed_data_end, wave_data->size - (size_t)(hashed_data_end - (const uint8_t*)wave_data->data));
+		*data_hash = rwl_finish_hash(&hash);
+	}
+	free(file_riff);
+	*sample_rate = file_sample_rate;
+	*sample_count = file_sample_count;
+	return 0;
+}
+
+static int rwl_load_wave(const char* file_name, float trim_threshold, size_t trim_block_length, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel, size_t* trim_offset, uint8_t* voice_activity, uint64_t* data_hash)
+{
+	size_t file_size;
+	void* file_data;
+	int error = rwl_load_file(file_name, &file_size, &file_data);
+	if (error)
+		return error;
+	error = rwl_decode_wave(file_size, file_data, trim_threshold, trim_block_length, sample_rate, sample_count, left_channel, rigth_channel, trim_offset, voice_activity, data_hash);
+	free(file_data);
+	return error;
+}
+
+int rwl_load_wave_file(const char* file_name, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel)
+{
+	return rwl_load_wave(file_name, 0.0f, 0, sample_rate, sample_count, left_channel, rigth_channel, 0, 0, 0);
+}
+
+int rwl_load_hashed_wave_file(const char* file_name, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel, uint64_t* data_hash)
+{
+	return rwl_load_wave(file_name, 0.0f, 0, sample_rate, sample_count, left_channel, rigth_channel, 0, 0, data_hash);
+}
+
+static int rwl_encode_wave(size_t sample_rate, size_t sample_count, const float* left_channel, const float* rigth_channel, size_t* buffer_size, void** buffer, size_t* wave_size)
+{
+	if (!left_channel && !rigth_channel)
+		return EINVAL;
+	size_t channel_count = (left_channel && rigth_channel) ? 2 : 1;
+	if (sample_count > (size_t)(0xFFFFFFFF - 36) / (channel_count * 4))
+		return EINVAL;
+	if (*buffer_size < 44 + (channel_count * sample_count * 4))
+	{
+		void* new_buffer = realloc(*buffer, 44 + (channel_count * sample_count * 4));
+		if (!new_buffer)
+			return ENOMEM;
+		*buffer = new_buffer;
+		*buffer_size = 44 + (channel_count * sample_count * 4);
+	}
+	uintptr_t wav = (uintptr_t)*buffer;
+	*(uint8_t*)(wav) = (uint8_t)'R';
+	*(uint8_t*)(wav + 1) = (uint8_t)'I';
 	*(uint8_t*)(wav + 2) = (uint8_t)'F';
 	*(uint8_t*)(wav + 3) = (uint8_t)'F';
 	*(uint32_t*)(wav + 4) = (uint32_t)(36 + (channel_count * sample_count * 4));
@@ -769,19 +2562,780 @@ int rwl_store_wave_file(const char* file_name, size_t sample_rate, size_t sample
 	if (channel_count == 1)
 		memcpy((void*)(wav + 44), left_channel ? left_channel : rigth_channel, sample_count * 4);
 	else
-		for (float* i = (float*)(wav + 44), * e = i + 2 * sample_count; i != e; ++left_channel, ++rigth_channel, i += 2)
+		for (float* i = (float*)(wav + 44), * e = i + 2 * sample_count; i != e; ++left_channel, ++rigth_channel, i += 2)
+		{
+			i[0] = *left_channel;
+			i[1] = *rigth_channel;
+		}
+	float signal_peak = rwl_get_signal_absolute_peak(channel_count * sample_count, (const float*)(wav + 44));
+	if (signal_peak > 0.0009765625f)
+		rwl_scale_signal(channel_count * sample_count, (float*)(wav + 44), 1.0f / signal_peak);
+	*wave_size = 44 + (channel_count * sample_count * 4);
+	return 0;
+}
+
+int rwl_store_wave_file(const char* file_name, size_t sample_rate, size_t sample_count, const float* left_channel, const float* rigth_channel)
+{
+	size_t wave_buffer_size = 0;
+	void* wave_buffer = 0;
+	size_t wave_size;
+	int error = rwl_encode_wave(sample_rate, sample_count, left_channel, rigth_channel, &wave_buffer_size, &wave_buffer, &wave_size);
+	if (error)
+		return error;
+	error = rwl_store_file(file_name, wave_size, wave_buffer);
+	free(wave_buffer);
+	return error;
+}
+
+int rwl_overwrite_wave_file(const char* file_name, size_t sample_offset, size_t sample_count, size_t channel_count, const float* frames)
+{
+	FILE* file = fopen(file_name, "r+b");
+	if (!file)
+		return errno;
+	int file_sample_type;
+	size_t file_sample_size;
+	size_t file_channel_count;
+	uint32_t file_channel_mask;
+	size_t file_sample_rate;
+	size_t file_sample_count;
+	uint64_t file_data_offset = 0;
+	int error = rwl_read_wave_file_header(file, &file_sample_type, &file_sample_size, &file_channel_count, &file_channel_mask, &file_sample_rate, &file_sample_count, &file_data_offset, 0, 0);
+	if (error)
+	{
+		fclose(file);
+		return error;
+	}
+	if (!rwl_is_supported_sample_format(file_sample_type, file_sample_size))
+	{
+		fclose(file);
+		return ENOTSUP;
+	}
+	if (channel_count != file_channel_count)
+	{
+		fclose(file);
+		return EINVAL;
+	}
+	if (sample_offset > file_sample_count || sample_count > file_sample_count - sample_offset)
+	{
+		fclose(file);
+		return ERANGE;
+	}
+	if (!sample_count)
+	{
+		fclose(file);
+		return 0;
+	}
+	size_t frame_size = file_channel_count * (file_sample_size / 8);
+	size_t block_length = sample_count < 4096 ? sample_count : 4096;
+	void* block = malloc(block_length * frame_size);
+	if (!block)
+	{
+		fclose(file);
+		return ENOMEM;
+	}
+	for (size_t offset = 0; !error && offset != sample_count;)
+	{
+		size_t frame_count = sample_count - offset < block_length ? sample_count - offset : block_length;
+		rwl_encode_samples(file_sample_type, file_sample_size, frame_count * channel_count, frames + offset * channel_count, block);
+		error = rwl_write_file_at(file, file_data_offset + (uint64_t)(sample_offset + offset) * (uint64_t)frame_size, frame_count * frame_size, block);
+		offset += frame_count;
+	}
+	free(block);
+	if (fclose(file) && !error)
+		error = EIO;
+	return error;
+}
+
+int rwl_concatenate_wave_files(const char* file_name, size_t source_file_count, const char** source_file_names)
+{
+	if (!source_file_count || source_file_count > (((size_t)~0) >> 1) / (sizeof(FILE*) + sizeof(uint64_t) + sizeof(size_t)))
+		return EINVAL;
+	FILE** source_files = (FILE**)malloc(source_file_count * (sizeof(FILE*) + sizeof(uint64_t) + sizeof(size_t)));
+	if (!source_files)
+		return ENOMEM;
+	uint64_t* source_offsets = (uint64_t*)((uintptr_t)source_files + source_file_count * sizeof(FILE*));
+	size_t* source_sizes = (size_t*)((uintptr_t)source_offsets + source_file_count * sizeof(uint64_t));
+	int error = 0;
+	size_t open_file_count = 0;
+	size_t fmt_size = 0;
+	uint8_t fmt_data[40];
+	int sample_type = 0;
+	size_t sample_size = 0;
+	size_t channel_count = 0;
+	uint32_t channel_mask = 0;
+	size_t sample_rate = 0;
+	uint64_t data_size = 0;
+	while (!error && open_file_count != source_file_count)
+	{
+		FILE* source_file = fopen(source_file_names[open_file_count], "rb");
+		if (!source_file)
+		{
+			error = errno;
+			break;
+		}
+		source_files[open_file_count++] = source_file;
+		int file_sample_type;
+		size_t file_sample_size;
+		size_t file_channel_count;
+		uint32_t file_channel_mask;
+		size_t file_sample_rate;
+		size_t file_sample_count;
+		error = rwl_read_wave_file_header(source_file, &file_sample_type, &file_sample_size, &file_channel_count, &file_channel_mask, &file_sample_rate, &file_sample_count, source_offsets + open_file_count - 1, &fmt_size, open_file_count == 1 ? (void*)fmt_data : 0);
+		if (error)
+			break;
+		if (open_file_count == 1)
+		{
+			sample_type = file_sample_type;
+			sample_size = file_sample_size;
+			channel_count = file_channel_count;
+			channel_mask = file_channel_mask;
+			sample_rate = file_sample_rate;
+		}
+		else if (file_sample_type != sample_type || file_sample_size != sample_size || file_channel_count != channel_count || file_channel_mask != channel_mask || file_sample_rate != sample_rate)
+		{
+			error = EILSEQ;
+			break;
+		}
+		source_sizes[open_file_count - 1] = file_sample_count * file_channel_count * (file_sample_size / 8);
+		data_size += (uint64_t)source_sizes[open_file_count - 1];
+		if (data_size > (uint64_t)0xFFFFFFFE - (uint64_t)(28 + fmt_size))
+			error = EFBIG;
+	}
+	if (!error)
+		error = rwl_create_wave_file_from_fmt(file_name, fmt_size, fmt_data, (size_t)data_size, source_file_count, source_files, source_offsets, source_sizes);
+	while (open_file_count)
+		fclose(source_files[--open_file_count]);
+	free(source_files);
+	return error;
+}
+
+int rwl_split_wave_file(const char* file_name, size_t segment_length, size_t* segment_count, const char** segment_file_names)
+{
+	if (!segment_length)
+		return EINVAL;
+	FILE* file = fopen(file_name, "rb");
+	if (!file)
+		return errno;
+	int file_sample_type;
+	size_t file_sample_size;
+	size_t file_channel_count;
+	uint32_t file_channel_mask;
+	size_t file_sample_rate;
+	size_t file_sample_count;
+	uint64_t file_data_offset;
+	size_t fmt_size;
+	uint8_t fmt_data[40];
+	int error = rwl_read_wave_file_header(file, &file_sample_type, &file_sample_size, &file_channel_count, &file_channel_mask, &file_sample_rate, &file_sample_count, &file_data_offset, &fmt_size, fmt_data);
+	if (error)
+	{
+		fclose(file);
+		return error;
+	}
+	size_t file_segment_count = (file_sample_count / segment_length) + ((file_sample_count % segment_length) ? 1 : 0);
+	if (!segment_file_names || *segment_count < file_segment_count)
+	{
+		fclose(file);
+		*segment_count = file_segment_count;
+		return segment_file_names ? ENOBUFS : 0;
+	}
+	size_t frame_size = file_channel_count * (file_sample_size / 8);
+	for (size_t i = 0; !error && i != file_segment_count; ++i)
+	{
+		size_t segment_sample_count = (i + 1 != file_segment_count || !(file_sample_count % segment_length)) ? segment_length : (file_sample_count % segment_length);
+		uint64_t segment_offset = file_data_offset + (uint64_t)i * (uint64_t)segment_length * (uint64_t)frame_size;
+		size_t segment_size = segment_sample_count * frame_size;
+		error = rwl_create_wave_file_from_fmt(segment_file_names[i], fmt_size, fmt_data, segment_size, 1, &file, &segment_offset, &segment_size);
+	}
+	fclose(file);
+	*segment_count = file_segment_count;
+	return error;
+}
+
+int rwl_transcode_wave_file(const char* source_file_name, const char* file_name, int sample_type, size_t sample_size, size_t channel_count)
+{
+	if (!channel_count || channel_count > 18 || !rwl_is_supported_sample_format(sample_type, sample_size))
+		return EINVAL;
+	FILE* source_file = fopen(source_file_name, "rb");
+	if (!source_file)
+		return errno;
+	rwl_transcoder transcoder;
+	size_t source_sample_rate;
+	size_t source_sample_count;
+	uint32_t source_channel_mask;
+	uint64_t source_data_offset;
+	size_t source_fmt_size;
+	uint8_t source_fmt_data[40];
+	int error = rwl_read_wave_file_header(source_file, &transcoder.source_sample_type, &transcoder.source_sample_size, &transcoder.source_channel_count, &source_channel_mask, &source_sample_rate, &source_sample_count, &source_data_offset, &source_fmt_size, source_fmt_data);
+	if (!error && !rwl_is_supported_sample_format(transcoder.source_sample_type, transcoder.source_sample_size))
+		error = ENOTSUP;
+	if (!error && transcoder.source_channel_count > 18)
+		error = ENOTSUP;
+	if (error)
+	{
+		fclose(source_file);
+		return error;
+	}
+	float mix_matrix[18 * 18];
+	transcoder.sample_type = sample_type;
+	transcoder.sample_size = sample_size;
+	transcoder.channel_count = channel_count;
+	transcoder.mix_matrix = mix_matrix;
+	if (channel_count == transcoder.source_channel_count)
+		transcoder.mix_matrix = 0;
+	else if (channel_count == 1)
+	{
+		for (size_t i = 0; i != transcoder.source_channel_count; ++i)
+			mix_matrix[i] = 1.0f / (float)transcoder.source_channel_count;
+	}
+	else if (channel_count == 2)
+	{
+		uint32_t source_channel_mask_channel_count = 0;
+		for (uint32_t i = 0; i != 18; ++i)
+			if (source_channel_mask & ((uint32_t)1 << i))
+				++source_channel_mask_channel_count;
+		if (source_channel_mask_channel_count != transcoder.source_channel_count)
+		{
+			fclose(source_file);
+			return ENOTSUP;
+		}
+		for (size_t j = 0; j != 2; ++j)
+		{
+			float sum = 0.0f;
+			for (size_t channel_index = 0, bit_index = 0; channel_index != transcoder.source_channel_count; ++bit_index, ++channel_index)
+			{
+				while (!(source_channel_mask & ((uint32_t)1 << (uint32_t)bit_index)))
+					++bit_index;
+				mix_matrix[j * transcoder.source_channel_count + channel_index] = rwl_stereo_channel_multipliers[bit_index][j];
+				sum += rwl_stereo_channel_multipliers[bit_index][j];
+			}
+			if (sum > 1.0f)
+				for (size_t k = 0; k != transcoder.source_channel_count; ++k)
+					mix_matrix[j * transcoder.source_channel_count + k] /= sum;
+		}
+	}
+	else
+	{
+		fclose(source_file);
+		return ENOTSUP;
+	}
+	size_t source_frame_size = transcoder.source_channel_count * (transcoder.source_sample_size / 8);
+	size_t frame_size = channel_count * (sample_size / 8);
+	if ((uint64_t)source_sample_count * (uint64_t)frame_size > (uint64_t)0xFFFFFFFE - (uint64_t)68)
+	{
+		fclose(source_file);
+		return EFBIG;
+	}
+	const size_t block_length = 16384;
+	size_t memory_size = (2 * source_frame_size + 2 * frame_size + (transcoder.source_channel_count + channel_count) * sizeof(float)) * block_length;
+	void* memory = malloc(memory_size);
+	if (!memory)
+	{
+		fclose(source_file);
+		return ENOMEM;
+	}
+	transcoder.source_samples = (float*)memory;
+	transcoder.samples = transcoder.source_samples + block_length * transcoder.source_channel_count;
+	void* source_blocks[2] = { (void*)(transcoder.samples + block_length * channel_count), 0 };
+	source_blocks[1] = (void*)((uintptr_t)source_blocks[0] + block_length * source_frame_size);
+	void* blocks[2] = { (void*)((uintptr_t)source_blocks[1] + block_length * source_frame_size), 0 };
+	blocks[1] = (void*)((uintptr_t)blocks[0] + block_length * frame_size);
+	rwl_block_queue* queues[4] = { &transcoder.source_free_queue, &transcoder.source_full_queue, &transcoder.free_queue, &transcoder.full_queue };
+	size_t queue_count = 0;
+	while (!error && queue_count != 4)
+	{
+		error = rwl_create_block_queue(queues[queue_count]);
+		if (!error)
+			++queue_count;
+	}
+	if (error)
+	{
+		while (queue_count)
+			rwl_destroy_block_queue(queues[--queue_count]);
+		free(memory);
+		fclose(source_file);
+		return error;
+	}
+	for (size_t i = 0; i != 2; ++i)
+	{
+		rwl_push_block(&transcoder.source_free_queue, source_blocks[i], 0);
+		rwl_push_block(&transcoder.free_queue, blocks[i], 0);
+	}
+	char* temporal_file_name;
+	error = rwl_create_temporal_file(file_name, &temporal_file_name, &transcoder.file);
+	if (error)
+	{
+		for (size_t i = 0; i != 4; ++i)
+			rwl_destroy_block_queue(queues[i]);
+		free(memory);
+		fclose(source_file);
+		return error;
+	}
+	uint8_t header[68];
+	size_t data_size = source_sample_count * frame_size;
+	uint32_t channel_mask = (channel_count == transcoder.source_channel_count && source_fmt_size == 40) ? source_channel_mask : rwl_get_default_channel_mask(channel_count);
+	size_t header_size = rwl_create_wave_header(sample_type, sample_size, channel_count, channel_mask, source_sample_rate, data_size, header);
+	if (fwrite(header, 1, header_size, transcoder.file) != header_size)
+		error = EIO;
+	rwl_thread convert_thread;
+	rwl_thread write_thread;
+	int thread_count = 0;
+	if (!error)
+		error = rwl_create_thread(&convert_thread, rwl_transcoder_convert_thread, &transcoder);
+	if (!error)
+	{
+		++thread_count;
+		error = rwl_create_thread(&write_thread, rwl_transcoder_write_thread, &transcoder);
+		if (!error)
+			++thread_count;
+	}
+	if (!error && rwl_seek_file(source_file, source_data_offset))
+		error = EIO;
+	for (size_t offset = 0; !error && offset != source_sample_count;)
+	{
+		void* source_block;
+		size_t unused_length;
+		error = rwl_pop_block(&transcoder.source_free_queue, &source_block, &unused_length);
+		if (error)
+			break;
+		size_t frame_count = source_sample_count - offset < block_length ? source_sample_count - offset : block_length;
+		if (fread(source_block, source_frame_size, frame_count, source_file) != frame_count)
 		{
-			i[0] = *left_channel;
-			i[1] = *rigth_channel;
+			error = EILSEQ;
+			break;
 		}
-	float signal_peak = rwl_get_signal_absolute_peak(channel_count * sample_count, (const float*)(wav + 44));
-	if (signal_peak > 0.0009765625f)
-		rwl_scale_signal(channel_count * sample_count, (float*)(wav + 44), 1.0f / signal_peak);
-	int error = rwl_store_file(file_name, 44 + (channel_count * sample_count * 4), (const void*)wav);
-	free((void*)wav);
+		rwl_push_block(&transcoder.source_full_queue, source_block, frame_count);
+		offset += frame_count;
+	}
+	if (!error)
+	{
+		void* source_block;
+		size_t unused_length;
+		error = rwl_pop_block(&transcoder.source_free_queue, &source_block, &unused_length);
+		if (!error)
+			rwl_push_block(&transcoder.source_full_queue, source_block, 0);
+	}
+	if (error)
+		rwl_abort_transcoder(&transcoder);
+	if (thread_count)
+	{
+		int thread_error = rwl_wait_thread(&convert_thread);
+		if (!error)
+			error = thread_error;
+	}
+	if (thread_count == 2)
+	{
+		int thread_error = rwl_wait_thread(&write_thread);
+		if (!error || error == ECANCELED)
+			error = thread_error ? thread_error : error;
+	}
+	if (!error && (data_size & 1) && fputc(0, transcoder.file) == EOF)
+		error = EIO;
+	if (fclose(transcoder.file) && !error)
+		error = EIO;
+	for (size_t i = 0; i != 4; ++i)
+		rwl_destroy_block_queue(queues[i]);
+	free(memory);
+	fclose(source_file);
+	if (error)
+	{
+		remove(temporal_file_name);
+		free(temporal_file_name);
+		return error;
+	}
+	error = rwl_replace_file(temporal_file_name, file_name);
+	free(temporal_file_name);
+	return error;
+}
+
+int rwl_index_directory(const char* directory_name, const char* index_file_name, size_t thread_count)
+{
+	if (!thread_count)
+		thread_count = rwl_get_processor_count();
+	rwl_directory_indexer indexer;
+	indexer.directory_name = directory_name;
+	indexer.directory_name_length = strlen(directory_name);
+	indexer.old_entry_count = 0;
+	indexer.old_entries = 0;
+	indexer.old_name_table = 0;
+	indexer.job_count = 0;
+	indexer.job_capacity = 0;
+	indexer.jobs = 0;
+	indexer.file_count = 0;
+	indexer.file_capacity = 0;
+	indexer.files = 0;
+	indexer.active_thread_count = 0;
+	indexer.error = 0;
+	size_t old_index_size;
+	void* old_index = 0;
+	if (!rwl_load_file(index_file_name, &old_index_size, &old_index) && rwl_validate_wave_index(old_index_size, old_index, &indexer.old_entry_count, &indexer.old_entries, &indexer.old_name_table))
+	{
+		free(old_index);
+		old_index = 0;
+	}
+	int error = rwl_create_monitor(&indexer.monitor);
+	if (error)
+	{
+		free(old_index);
+		return error;
+	}
+	char* root_name = (char*)malloc(1);
+	rwl_wave_index_entry root_entry;
+	memset(&root_entry, 0, sizeof(rwl_wave_index_entry));
+	if (!root_name)
+		error = ENOMEM;
+	else
+	{
+		*root_name = 0;
+		error = rwl_append_indexed_file(&indexer, 1, root_name, 1, &root_entry);
+		if (error)
+			free(root_name);
+	}
+	rwl_thread* threads = 0;
+	if (!error && thread_count > 1)
+	{
+		threads = (rwl_thread*)malloc((thread_count - 1) * sizeof(rwl_thread));
+		if (!threads)
+			thread_count = 1;
+	}
+	size_t started_thread_count = 0;
+	while (!error && started_thread_count != thread_count - 1)
+	{
+		if (rwl_create_thread(threads + started_thread_count, rwl_directory_indexer_thread, &indexer))
+			break;
+		++started_thread_count;
+	}
+	if (!error)
+		rwl_directory_indexer_thread(&indexer);
+	while (started_thread_count)
+		rwl_wait_thread(threads + --started_thread_count);
+	free(threads);
+	rwl_destroy_monitor(&indexer.monitor);
+	free(old_index);
+	while (indexer.job_count)
+		free(indexer.jobs[--indexer.job_count].name);
+	free(indexer.jobs);
+	if (!error)
+		error = indexer.error;
+	uint64_t name_table_size = 0;
+	for (size_t i = 0; i != indexer.file_count; ++i)
+		name_table_size += (uint64_t)strlen(indexer.files[i].name) + 1;
+	uint64_t index_size = (uint64_t)sizeof(rwl_wave_index_header) + (uint64_t)indexer.file_count * (uint64_t)sizeof(rwl_wave_index_entry) + name_table_size;
+	if (!error && index_size > (uint64_t)(((size_t)~0) >> 1))
+		error = EFBIG;
+	void* index = 0;
+	if (!error)
+	{
+		index = malloc((size_t)index_size);
+		if (!index)
+			error = ENOMEM;
+	}
+	if (!error)
+	{
+		if (indexer.file_count)
+			qsort(indexer.files, indexer.file_count, sizeof(rwl_indexed_file), rwl_compare_indexed_files);
+		rwl_wave_index_header* header = (rwl_wave_index_header*)index;
+		rwl_wave_index_entry* entries = (rwl_wave_index_entry*)((uintptr_t)index + sizeof(rwl_wave_index_header));
+		char* name_table = (char*)((uintptr_t)entries + indexer.file_count * sizeof(rwl_wave_index_entry));
+		memcpy(header->identifier, "RWLI", 4);
+		header->version = 1;
+		header->entry_count = (uint64_t)indexer.file_count;
+		header->name_table_offset = (uint64_t)((uintptr_t)name_table - (uintptr_t)index);
+		header->name_table_size = name_table_size;
+		for (size_t name_offset = 0, i = 0; i != indexer.file_count; ++i)
+		{
+			size_t name_length = strlen(indexer.files[i].name);
+			entries[i] = indexer.files[i].entry;
+			entries[i].name_offset = (uint64_t)name_offset;
+			entries[i].name_length = (uint32_t)name_length;
+			memcpy(name_table + name_offset, indexer.files[i].name, name_length + 1);
+			name_offset += name_length + 1;
+		}
+		error = rwl_store_file(index_file_name, (size_t)index_size, index);
+		free(index);
+	}
+	for (size_t i = 0; i != indexer.file_count; ++i)
+		free(indexer.files[i].name);
+	free(indexer.files);
+	return error;
+}
+
+int rwl_map_wave_index(const char* index_file_name, size_t* entry_count, const rwl_wave_index_entry** entries, const char** name_table, void** mapping)
+{
+	rwl_wave_index_mapping* index_mapping = (rwl_wave_index_mapping*)malloc(sizeof(rwl_wave_index_mapping));
+	if (!index_mapping)
+		return ENOMEM;
+#ifdef _WIN32
+	index_mapping->file = CreateFileA(index_file_name, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (index_mapping->file == INVALID_HANDLE_VALUE)
+	{
+		free(index_mapping);
+		return ENOENT;
+	}
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(index_mapping->file, &file_size) || (uint64_t)file_size.QuadPart > (uint64_t)(((size_t)~0) >> 1) || (size_t)file_size.QuadPart < sizeof(rwl_wave_index_header))
+	{
+		CloseHandle(index_mapping->file);
+		free(index_mapping);
+		return EILSEQ;
+	}
+	index_mapping->size = (size_t)file_size.QuadPart;
+	index_mapping->mapping = CreateFileMappingA(index_mapping->file, 0, PAGE_READONLY, 0, 0, 0);
+	index_mapping->data = index_mapping->mapping ? MapViewOfFile(index_mapping->mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+	if (!index_mapping->data)
+	{
+		if (index_mapping->mapping)
+			CloseHandle(index_mapping->mapping);
+		CloseHandle(index_mapping->file);
+		free(index_mapping);
+		return ENOMEM;
+	}
+#else
+	int file_descriptor = open(index_file_name, O_RDONLY);
+	if (file_descriptor == -1)
+	{
+		int error = errno;
+		free(index_mapping);
+		return error;
+	}
+	struct stat file_status;
+	if (fstat(file_descriptor, &file_status) || (uint64_t)file_status.st_size > (uint64_t)(((size_t)~0) >> 1) || (size_t)file_status.st_size < sizeof(rwl_wave_index_header))
+	{
+		close(file_descriptor);
+		free(index_mapping);
+		return EILSEQ;
+	}
+	index_mapping->size = (size_t)file_status.st_size;
+	index_mapping->data = mmap(0, index_mapping->size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+	close(file_descriptor);
+	if (index_mapping->data == MAP_FAILED)
+	{
+		int error = errno;
+		free(index_mapping);
+		return error;
+	}
+#endif
+	int error = rwl_validate_wave_index(index_mapping->size, index_mapping->data, entry_count, entries, name_table);
+	if (error)
+	{
+		rwl_unmap_wave_index(index_mapping);
+		return error;
+	}
+	*mapping = (void*)index_mapping;
+	return 0;
+}
+
+void rwl_unmap_wave_index(void* mapping)
+{
+	rwl_wave_index_mapping* index_mapping = (rwl_wave_index_mapping*)mapping;
+#ifdef _WIN32
+	UnmapViewOfFile(index_mapping->data);
+	CloseHandle(index_mapping->mapping);
+	CloseHandle(index_mapping->file);
+#else
+	munmap(index_mapping->data, index_mapping->size);
+#endif
+	free(index_mapping);
+}
+
+int rwl_load_trimmed_wave_file(const char* file_name, float threshold, size_t block_length, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel, size_t* trim_offset, uint8_t* voice_activity)
+{
+	if (!block_length || !(threshold >= 0.0f))
+		return EINVAL;
+	return rwl_load_wave(file_name, threshold, block_length, sample_rate, sample_count, left_channel, rigth_channel, trim_offset, voice_activity, 0);
+}
+
+int rwl_parallel_store_wave_file(const char* file_name, size_t sample_rate, size_t sample_count, const float* left_channel, const float* rigth_channel, size_t thread_count)
+{
+	if (!left_channel && !rigth_channel)
+		return EINVAL;
+	if (!thread_count)
+		thread_count = rwl_get_processor_count();
+	rwl_parallel_store store;
+	store.channel_count = (left_channel && rigth_channel) ? 2 : 1;
+	store.sample_count = sample_count;
+	store.left_channel = left_channel;
+	store.rigth_channel = rigth_channel;
+	store.thread_count = thread_count;
+	store.peak_thread_index = 0;
+	store.block_length = 65536;
+	store.block_count = (sample_count / store.block_length) + ((sample_count % store.block_length) ? 1 : 0);
+	store.slot_count = store.block_count < 2 * thread_count ? store.block_count : 2 * thread_count;
+	if (!store.slot_count)
+		store.slot_count = 1;
+	store.next_block = 0;
+	store.written_block_count = 0;
+	store.abort = 0;
+	if ((uint64_t)store.channel_count * (uint64_t)sample_count * 4 > (uint64_t)0xFFFFFFFF - 36 || thread_count > (((size_t)~0) >> 1) / (sizeof(rwl_thread) + sizeof(float) + 2 * (store.block_length * store.channel_count * sizeof(float) + 1)))
+		return EINVAL;
+	size_t memory_size = store.slot_count * store.block_length * store.channel_count * sizeof(float) + thread_count * (sizeof(rwl_thread) + sizeof(float)) + store.slot_count;
+	void* memory = malloc(memory_size);
+	if (!memory)
+		return ENOMEM;
+	store.slots = (float*)memory;
+	rwl_thread* threads = (rwl_thread*)((uintptr_t)memory + store.slot_count * store.block_length * store.channel_count * sizeof(float));
+	store.thread_peaks = (float*)((uintptr_t)threads + thread_count * sizeof(rwl_thread));
+	store.ready_slots = (uint8_t*)((uintptr_t)store.thread_peaks + thread_count * sizeof(float));
+	memset(store.ready_slots, 0, store.slot_count);
+	int error = rwl_create_monitor(&store.monitor);
+	if (error)
+	{
+		free(memory);
+		return error;
+	}
+	rwl_run_parallel_store_threads(&store, rwl_parallel_store_peak_thread, threads);
+	float signal_peak = 0.0f;
+	for (size_t i = 0; i != thread_count; ++i)
+		if (store.thread_peaks[i] > signal_peak)
+			signal_peak = store.thread_peaks[i];
+	store.multiplier = signal_peak > 0.0009765625f ? 1.0f / signal_peak : 1.0f;
+	char* temporal_file_name;
+	FILE* file;
+	error = rwl_create_temporal_file(file_name, &temporal_file_name, &file);
+	if (error)
+	{
+		rwl_destroy_monitor(&store.monitor);
+		free(memory);
+		return error;
+	}
+	uint8_t header[68];
+	size_t header_size = rwl_create_wave_header(RWL_SAMPLE_TYPE_FLOAT, 32, store.channel_count, rwl_get_default_channel_mask(store.channel_count), sample_rate, store.channel_count * sample_count * 4, header);
+	if (fwrite(header, 1, header_size, file) != header_size)
+		error = EIO;
+	size_t writer_thread_count = 0;
+	while (!error && writer_thread_count != thread_count)
+	{
+		if (rwl_create_thread(threads + writer_thread_count, rwl_parallel_store_convert_thread, &store))
+			break;
+		++writer_thread_count;
+	}
+	for (size_t block_index = 0; !error && block_index != store.block_count; ++block_index)
+	{
+		if (writer_thread_count)
+		{
+			rwl_enter_monitor(&store.monitor);
+			while (!store.ready_slots[block_index % store.slot_count])
+				rwl_wait_monitor(&store.monitor);
+			rwl_leave_monitor(&store.monitor);
+		}
+		else
+			rwl_convert_parallel_store_block(&store, block_index);
+		size_t block_sample_count = sample_count - block_index * store.block_length < store.block_length ? sample_count - block_index * store.block_length : store.block_length;
+		if (fwrite(store.slots + (block_index % store.slot_count) * store.block_length * store.channel_count, store.channel_count * sizeof(float), block_sample_count, file) != block_sample_count)
+			error = EIO;
+		rwl_enter_monitor(&store.monitor);
+		store.ready_slots[block_index % store.slot_count] = 0;
+		store.written_block_count++;
+		rwl_notify_monitor(&store.monitor);
+		rwl_leave_monitor(&store.monitor);
+	}
+	if (error)
+	{
+		rwl_enter_monitor(&store.monitor);
+		store.abort = 1;
+		rwl_notify_monitor(&store.monitor);
+		rwl_leave_monitor(&store.monitor);
+	}
+	while (writer_thread_count)
+		rwl_wait_thread(threads + --writer_thread_count);
+	rwl_destroy_monitor(&store.monitor);
+	free(memory);
+	if (fflush(file) && !error)
+		error = EIO;
+	if (fclose(file) && !error)
+		error = EIO;
+	if (error)
+	{
+		remove(temporal_file_name);
+		free(temporal_file_name);
+		return error;
+	}
+	error = rwl_replace_file(temporal_file_name, file_name);
+	free(temporal_file_name);
+	return error;
+}
+
+int rwl_load_wave_memory(size_t size, const void* data, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel)
+{
+	return rwl_decode_wave(size, data, 0.0f, 0, sample_rate, sample_count, left_channel, rigth_channel, 0, 0, 0);
+}
+
+int rwl_store_wave_memory(size_t sample_rate, size_t sample_count, const float* left_channel, const float* rigth_channel, size_t* buffer_size, void** buffer, size_t* wave_size)
+{
+	return rwl_encode_wave(sample_rate, sample_count, left_channel, rigth_channel, buffer_size, buffer, wave_size);
+}
+
+int rwl_load_wave_stream(const rwl_io* io, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel)
+{
+	if (!io->read)
+		return EINVAL;
+	if (!left_channel && !rigth_channel && io->seek)
+	{
+		int stream_sample_type;
+		size_t stream_sample_size;
+		size_t stream_channel_count;
+		uint32_t stream_channel_mask;
+		size_t stream_sample_rate;
+		size_t stream_sample_count;
+		uint64_t stream_data_offset;
+		int error = rwl_read_wave_header(io, &stream_sample_type, &stream_sample_size, &stream_channel_count, &stream_channel_mask, &stream_sample_rate, &stream_sample_count, &stream_data_offset, 0, 0);
+		if (error)
+			return error;
+		if (!rwl_is_supported_sample_format(stream_sample_type, stream_sample_size))
+			return ENOTSUP;
+		*sample_rate = stream_sample_rate;
+		*sample_count = stream_sample_count;
+		return 0;
+	}
+	if (io->seek && io->seek(io->context, 0))
+		return EIO;
+	size_t size = 0;
+	size_t buffer_size = 0x10000;
+	void* buffer = malloc(buffer_size);
+	if (!buffer)
+		return ENOMEM;
+	for (size_t read_result = 1; read_result;)
+	{
+		if (size == buffer_size)
+		{
+			void* new_buffer = buffer_size <= (((size_t)~0) >> 1) ? realloc(buffer, 2 * buffer_size) : 0;
+			if (!new_buffer)
+			{
+				free(buffer);
+				return ENOMEM;
+			}
+			buffer = new_buffer;
+			buffer_size *= 2;
+		}
+		read_result = io->read(io->context, (void*)((uintptr_t)buffer + size), buffer_size - size);
+		size += read_result;
+	}
+	int error = rwl_decode_wave(size, buffer, 0.0f, 0, sample_rate, sample_count, left_channel, rigth_channel, 0, 0, 0);
+	free(buffer);
+	return error;
+}
+
+int rwl_store_wave_stream(const rwl_io* io, size_t sample_rate, size_t sample_count, const float* left_channel, const float* rigth_channel)
+{
+	if (!io->write)
+		return EINVAL;
+	size_t buffer_size = 0;
+	void* buffer = 0;
+	size_t wave_size;
+	int error = rwl_encode_wave(sample_rate, sample_count, left_channel, rigth_channel, &buffer_size, &buffer, &wave_size);
+	if (error)
+		return error;
+	if (io->seek && io->seek(io->context, 0))
+		error = EIO;
+	for (size_t written = 0, write_result; !error && written != wave_size; written += write_result)
+	{
+		write_result = io->write(io->context, (const void*)((uintptr_t)buffer + written), wave_size - written);
+		if (!write_result)
+			error = EIO;
+	}
+	free(buffer);
 	return error;
 }
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
@@ -1,5 +1,5 @@
 /*
-	Raw Wave Library version 1.0.2 2019-02-07 by Santtu Nyman.
+	Raw Wave Library version 1.1.0 2026-10-18 by Santtu Nyman.
 	git repository https://github.com/Santtu-Nyman/rwl
 	
 	Description
@@ -7,6 +7,18 @@
 		Usage documentation is written to the rwl header after function declarations.
 		
 	Version history
+		Version 1.1.0 2026-10-18
+			Added real-time safe wave file recorder.
+			Added in-place overwriting of samples in existing wave files.
+			Added concatenating and splitting of wave files without converting samples.
+			Added pipelined converting of wave files to other sample formats and channel counts.
+			Added parallel indexing of wave files in directory trees.
+			Added loading of wave files with leading and trailing silence trimmed.
+			Fixed loading functions not writing sample rate and sample count on success.
+			Added parallel storing of wave files.
+			Added loading and storing of wave files from memory buffers and user defined streams.
+			Fixed reading past the end of truncated files and files without format chunk.
+			Added hashing of wave file sample data while loading.
 		Version 1.0.2 2019-02-07
 			Removed useless macro on non Windows platforms.
 		Version 1.0.1 2018-09-05
@@ -25,6 +37,45 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 
+#define RWL_SAMPLE_TYPE_PCM 1
+#define RWL_SAMPLE_TYPE_FLOAT 3
+
+typedef struct rwl_recorder rwl_recorder;
+
+typedef struct rwl_io
+{
+	void* context;
+	size_t (*read)(void* context, void* buffer, size_t size);
+	int (*seek)(void* context, uint64_t offset);
+	size_t (*write)(void* context, const void* data, size_t size);
+} rwl_io;
+
+typedef struct rwl_wave_index_header
+{
+	char identifier[4];
+	uint32_t version;
+	uint64_t entry_count;
+	uint64_t name_table_offset;
+	uint64_t name_table_size;
+} rwl_wave_index_header;
+
+typedef struct rwl_wave_index_entry
+{
+	uint64_t name_offset;
+	uint64_t file_size;
+	int64_t modification_time;
+	uint64_t data_offset;
+	uint64_t sample_count;
+	uint32_t sample_rate;
+	uint32_t channel_mask;
+	uint32_t name_length;
+	uint32_t error;
+	uint16_t sample_type;
+	uint16_t sample_size;
+	uint16_t channel_count;
+	uint16_t reserved;
+} rwl_wave_index_entry;
+
 int rwl_load_wave_file(const char* file_name, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel);
 /*
 	Description
@@ -49,6 +100,114 @@ int rwl_load_wave_file(const char* file_name, size_t* sample_rate, size_t* sampl
 		If the function succeeds, the return value is zero and non zero on failure.
 */
 
+int rwl_load_wave_memory(size_t size, const void* data, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel);
+/*
+	Description
+		Function works like rwl_load_wave_file, but the wave file is read from a memory buffer.
+	Parameters
+		size
+			Size of the buffer in bytes.
+		data
+			Pointer to the buffer that contains the wave file.
+		sample_rate
+			Pointer variable that receives file's sample rate.
+		sample_count
+			Pointer to variable that specifies length of channel buffers in samples.
+			Function overwrites value of this variable with file's per channel sample count.
+		left_channel
+			Pointer to left channel's buffer.
+		rigth_channel
+			Pointer to rigth channel's buffer.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+int rwl_load_wave_stream(const rwl_io* io, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel);
+/*
+	Description
+		Function works like rwl_load_wave_file, but the wave file is read with user defined callbacks.
+		The read callback receives the context, a buffer and the buffer's size in bytes and returns number of bytes it read.
+		Return value zero means that the end of the stream is reached or an error occurred.
+		The seek callback receives the context and an offset in bytes from the beginning of the wave file and returns zero on success.
+		If seek callback is not null the stream is moved to the beginning before reading and if both channel
+		pointers are null only the file's header chunks are read. If seek callback is null the stream is read from its current position.
+		Write callback is not used.
+	Parameters
+		io
+			Pointer to the callbacks and their context.
+		sample_rate
+			Pointer variable that receives file's sample rate.
+		sample_count
+			Pointer to variable that specifies length of channel buffers in samples.
+			Function overwrites value of this variable with file's per channel sample count.
+		left_channel
+			Pointer to left channel's buffer.
+		rigth_channel
+			Pointer to rigth channel's buffer.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+int rwl_load_trimmed_wave_file(const char* file_name, float threshold, size_t block_length, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel, size_t* trim_offset, uint8_t* voice_activity);
+/*
+	Description
+		Function works like rwl_load_wave_file, but leading and trailing silence is trimmed from the loaded signal.
+		The file's samples are divided to blocks and a block is active if root mean square of all its samples
+		is at least the threshold. The loaded range starts at the first active block and ends at the end of the last active block.
+		Samples outside the loaded range are not written to the channel buffers and they do not affect normalization.
+		If no block is active sample count is set to zero.
+	Parameters
+		file_name
+			Pointer to name of the wave file.
+		threshold
+			Root mean square threshold of active blocks relative to full scale before normalization. For example 0.01 is -40 dBFS.
+		block_length
+			Length of blocks in samples per channel.
+		sample_rate
+			Pointer variable that receives file's sample rate.
+		sample_count
+			Pointer to variable that specifies length of channel buffers in samples.
+			Function overwrites value of this variable with number of loaded samples per channel.
+		left_channel
+			Pointer to left channel's buffer.
+		rigth_channel
+			Pointer to rigth channel's buffer.
+		trim_offset
+			Pointer to variable that receives index of the first loaded sample in the file.
+		voice_activity
+			Pointer to buffer that receives one value for every block in the loaded range. The value is 1 for active blocks and 0 for silent blocks.
+			The buffer length must be at least length of channel buffers divided by block length rounded up. This parameter may be null.
+			If both channel pointers are null the mask is still written and the buffer length must be at least
+			file's per channel sample count divided by block length rounded up.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+int rwl_load_hashed_wave_file(const char* file_name, size_t* sample_rate, size_t* sample_count, float* left_channel, float* rigth_channel, uint64_t* data_hash);
+/*
+	Description
+		Function works like rwl_load_wave_file, but it also computes a 64-bit XXH64 hash with seed zero of the file's data chunk.
+		The hash is computed from the raw bytes of the data chunk while the samples are converted and other chunks do not affect it.
+		Files with identical sample data have the same hash regardless of their metadata chunks.
+		If both channel pointers are null the data chunk is read and hashed without converting any samples.
+	Parameters
+		file_name
+			Pointer to name of the wave file.
+		sample_rate
+			Pointer variable that receives file's sample rate.
+		sample_count
+			Pointer to variable that specifies length of channel buffers in samples.
+			Function overwrites value of this variable with file's per channel sample count.
+		left_channel
+			Pointer to left channel's buffer.
+		rigth_channel
+			Pointer to rigth channel's buffer.
+		data_hash
+			Pointer to variable that receives the hash of the data chunk.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
 int rwl_store_wave_file(const char* file_name, size_t sample_rate, size_t sample_count, const float* left_channel, const float* rigth_channel);
 /*
 	Description
@@ -70,6 +229,301 @@ int rwl_store_wave_file(const char* file_name, size_t sample_rate, size_t sample
 		If the function succeeds, the return value is zero and non zero on failure.
 */
 
+int rwl_create_recorder(const char* file_name, size_t sample_rate, size_t channel_count, int sample_type, size_t sample_size, size_t queue_length, rwl_recorder** recorder);
+/*
+	Description
+		Function creates a recorder that writes interleaved frames to a raw wave file from a background thread.
+		The file is created immediately and the sizes in the file's header are rewritten after every second of stored audio,
+		so that the file is playable up to the last header update even if the process terminates without closing the recorder.
+		Integer samples are clamped to range from -1.0 to 1.0. Float samples are written as they are, except that NaN is written as zero. Samples are not normalized.
+		The recorder must be closed with rwl_close_recorder function.
+	Parameters
+		file_name
+			Pointer to name of the wave file.
+		sample_rate
+			Wave file's sample rate.
+		channel_count
+			Number of channels in a frame. Value must be from 1 to 18.
+		sample_type
+			Type of samples in the file. Value must be RWL_SAMPLE_TYPE_PCM or RWL_SAMPLE_TYPE_FLOAT.
+		sample_size
+			Size of single sample in bits. Value must be 8, 16, 24 or 32 for PCM samples and 32 for float samples.
+		queue_length
+			Length of the queue between the writing thread and the background thread in frames.
+			The length is rounded up to power of two.
+		recorder
+			Pointer to variable that receives address of the recorder.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+size_t rwl_write_recorder(rwl_recorder* recorder, size_t frame_count, const float* frames);
+/*
+	Description
+		Function appends frames to the recorder's queue. This function does not block, lock or allocate memory and
+		it may be called from a real-time thread. Only one thread may write to a recorder.
+		Frames that do not fit to the queue are discarded and counted as lost.
+	Parameters
+		recorder
+			Pointer to the recorder.
+		frame_count
+			Number of frames to write.
+		frames
+			Pointer to frame_count interleaved frames.
+	Return
+		The return value is number of frames that were queued.
+*/
+
+int rwl_get_recorder_status(rwl_recorder* recorder, size_t* stored_frame_count, size_t* lost_frame_count, size_t* overrun_count);
+/*
+	Description
+		Function reads counters of the recorder. This function may be called from any thread.
+	Parameters
+		recorder
+			Pointer to the recorder.
+		stored_frame_count
+			Pointer to variable that receives number of frames written to the file. This parameter may be null.
+		lost_frame_count
+			Pointer to variable that receives number of frames discarded because the queue was full. This parameter may be null.
+		overrun_count
+			Pointer to variable that receives number of rwl_write_recorder calls that discarded frames. This parameter may be null.
+	Return
+		The return value is zero if the background thread has not failed to write the file and the error code of the failure otherwise.
+*/
+
+int rwl_close_recorder(rwl_recorder* recorder);
+/*
+	Description
+		Function writes remaining queued frames to the file, finishes the file's header and frees the recorder.
+	Parameters
+		recorder
+			Pointer to the recorder.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+int rwl_store_wave_memory(size_t sample_rate, size_t sample_count, const float* left_channel, const float* rigth_channel, size_t* buffer_size, void** buffer, size_t* wave_size);
+/*
+	Description
+		Function works like rwl_store_wave_file, but the wave file is written to a memory buffer.
+		If the buffer is too small the function grows it with realloc.
+	Parameters
+		sample_rate
+			Wave file's sample rate.
+		sample_count
+			Number of samples in all channel buffers per channel that have non zero pointer.
+		left_channel
+			Pointer to left channel's buffer.
+		rigth_channel
+			Pointer to rigth channel's buffer.
+		buffer_size
+			Pointer to variable that specifies size of the buffer in bytes.
+			Function overwrites value of this variable with new size of the buffer if the buffer is grown.
+		buffer
+			Pointer to variable that specifies address of the buffer. The buffer must be null or allocated with malloc.
+			Function overwrites value of this variable with new address of the buffer if the buffer is grown.
+			The caller must free the buffer with free.
+		wave_size
+			Pointer to variable that receives size of the wave file in bytes.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+int rwl_store_wave_stream(const rwl_io* io, size_t sample_rate, size_t sample_count, const float* left_channel, const float* rigth_channel);
+/*
+	Description
+		Function works like rwl_store_wave_file, but the wave file is written with user defined callbacks.
+		The write callback receives the context, pointer to data and the data's size in bytes and returns number of bytes it wrote.
+		Return value zero means that an error occurred. If seek callback is not null the stream is moved to
+		the beginning before writing. Read callback is not used.
+	Parameters
+		io
+			Pointer to the callbacks and their context.
+		sample_rate
+			Wave file's sample rate.
+		sample_count
+			Number of samples in all channel buffers per channel that have non zero pointer.
+		left_channel
+			Pointer to left channel's buffer.
+		rigth_channel
+			Pointer to rigth channel's buffer.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+int rwl_parallel_store_wave_file(const char* file_name, size_t sample_rate, size_t sample_count, const float* left_channel, const float* rigth_channel, size_t thread_count);
+/*
+	Description
+		Function works like rwl_store_wave_file and writes identical file, but the work is done by multiple threads.
+		Threads first find peak of the signal in parallel and then interleave and scale blocks of the signal in parallel
+		while the calling thread writes finished blocks to the file in order.
+		Memory used for the blocks does not depend on the signal's length.
+	Parameters
+		file_name
+			Pointer to name of the wave file.
+		sample_rate
+			Wave file's sample rate.
+		sample_count
+			Number of samples in all channel buffers per channel that have non zero pointer.
+		left_channel
+			Pointer to left channel's buffer.
+		rigth_channel
+			Pointer to rigth channel's buffer.
+		thread_count
+			Number of threads converting blocks. If this value is zero the number of processors is used.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+int rwl_overwrite_wave_file(const char* file_name, size_t sample_offset, size_t sample_count, size_t channel_count, const float* frames);
+/*
+	Description
+		Function overwrites a range of samples in an existing raw wave file without rewriting rest of the file.
+		Frames are converted to the file's sample format and only the bytes of the overwritten range are written.
+		Integer samples are clamped to range from -1.0 to 1.0. Float samples are written as they are, except that NaN is written as zero. Samples are not normalized.
+		If the file is shorter than its header claims the function fails with EILSEQ and the file is not modified.
+	Parameters
+		file_name
+			Pointer to name of the wave file.
+		sample_offset
+			Index of the first overwritten sample per channel.
+		sample_count
+			Number of overwritten samples per channel. The range must be within the file's samples.
+		channel_count
+			Number of channels in the frames. This value must be same as the file's channel count.
+		frames
+			Pointer to sample_count interleaved frames.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+int rwl_concatenate_wave_files(const char* file_name, size_t source_file_count, const char** source_file_names);
+/*
+	Description
+		Function creates a raw wave file that contains samples of all source files one after another.
+		All source files must have same sample format, channel layout and sample rate.
+		Samples are copied as they are stored in the source files without converting or normalizing them and
+		on Linux the copying is done by the kernel without passing the data through user space when possible.
+	Parameters
+		file_name
+			Pointer to name of the created wave file.
+		source_file_count
+			Number of source files.
+		source_file_names
+			Pointer to array of source_file_count pointers to names of the source files.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+int rwl_split_wave_file(const char* file_name, size_t segment_length, size_t* segment_count, const char** segment_file_names);
+/*
+	Description
+		Function splits a raw wave file to segments of equal length and writes every segment to its own file.
+		Length of the last segment is the remainder of the file's samples if it is not multiple of segment length.
+		Samples are copied the same way as with rwl_concatenate_wave_files function.
+		If segment_file_names is null the function only writes the number of segments to segment_count variable.
+	Parameters
+		file_name
+			Pointer to name of the wave file that is split.
+		segment_length
+			Length of segments in samples per channel.
+		segment_count
+			Pointer to variable that specifies length of segment_file_names array.
+			Function overwrites value of this variable with number of segments.
+		segment_file_names
+			Pointer to array of pointers to names of the segment files.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+		If segment_file_names array is too short, the return value is ENOBUFS.
+*/
+
+int rwl_transcode_wave_file(const char* source_file_name, const char* file_name, int sample_type, size_t sample_size, size_t channel_count);
+/*
+	Description
+		Function converts a raw wave file to a raw wave file with another sample format and channel count.
+		The source file is processed in fixed size blocks, so memory usage does not depend on the file's size.
+		Reading the source file, converting samples and writing the new file are done concurrently by separate threads.
+		If channel count changes to one all source channels are averaged and if channel count changes to two
+		source channels are mixed to left and right channels the same way as by rwl_load_wave_file function
+		scaled so that no output channel has total gain above one. Other channel count changes are not supported.
+		If channel count is not changed the channel mask of an extensible source file is kept. Otherwise the new file's channels are front center or front left and right.
+		Sample rate is not changed. Integer samples are clamped to range from -1.0 to 1.0. Float samples are written as they are, except that NaN is written as zero. Samples are not normalized.
+	Parameters
+		source_file_name
+			Pointer to name of the converted wave file.
+		file_name
+			Pointer to name of the created wave file.
+		sample_type
+			Type of samples in the created file. Value must be RWL_SAMPLE_TYPE_PCM or RWL_SAMPLE_TYPE_FLOAT.
+		sample_size
+			Size of single sample in bits. Value must be 8, 16, 24 or 32 for PCM samples and 32 for float samples.
+		channel_count
+			Number of channels in the created file.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+int rwl_index_directory(const char* directory_name, const char* index_file_name, size_t thread_count);
+/*
+	Description
+		Function finds all files with .wav extension in a directory and its sub directories and writes format
+		information of every found file to an index file. Only the header chunks of the files are read.
+		If the index file already exists, information of files whose size and modification time have not changed
+		is copied from the old index and these files are not opened. Files whose format could not be read are always read again.
+		Symbolic links to directories are not followed.
+		If the directory or any of its sub directories can not be opened the function fails and the index file is not changed.
+		
+		The index file is designed to be mapped to memory. It starts with rwl_wave_index_header structure
+		that is followed by entry_count rwl_wave_index_entry structures sorted by file name and the name table.
+		Identifier of the header is "RWLI" and version is 1. All values are stored in the byte order of the host that wrote the index.
+		An index written by a host with another byte order has an invalid version, so it is rebuilt and it can not be mapped.
+		File names are relative to the indexed directory, use '/' as separator and are stored to the name table
+		as null terminated strings at name_offset bytes from the beginning of the name table.
+		The modification time is in nanoseconds since 1970-01-01 00:00:00 UTC and data offset is offset of
+		the file's sample data in bytes. If format of the file could not be read, error member of the entry is
+		the error code and the format members are zero.
+	Parameters
+		directory_name
+			Pointer to name of the indexed directory.
+		index_file_name
+			Pointer to name of the index file.
+		thread_count
+			Number of threads used to index the directory. If this value is zero the number of processors is used.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+int rwl_map_wave_index(const char* index_file_name, size_t* entry_count, const rwl_wave_index_entry** entries, const char** name_table, void** mapping);
+/*
+	Description
+		Function maps index file created by rwl_index_directory function to memory and validates it.
+		The mapping must be released with rwl_unmap_wave_index function.
+	Parameters
+		index_file_name
+			Pointer to name of the index file.
+		entry_count
+			Pointer to variable that receives number of entries in the index.
+		entries
+			Pointer to variable that receives address of the index entries.
+		name_table
+			Pointer to variable that receives address of the index name table.
+		mapping
+			Pointer to variable that receives handle of the mapping.
+	Return
+		If the function succeeds, the return value is zero and non zero on failure.
+*/
+
+void rwl_unmap_wave_index(void* mapping);
+/*
+	Description
+		Function releases index mapping created by rwl_map_wave_index function.
+	Parameters
+		mapping
+			Handle of the mapping.
+	Return
+		None
+*/
+
 #ifdef __cplusplus
 }
 #endif